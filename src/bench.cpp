@@ -0,0 +1,126 @@
+#include "bench.hpp"
+
+#include <chrono>
+#include <format>
+#include <vector>
+
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <hyprland/src/managers/animation/DesktopAnimationManager.hpp>
+
+#include "config.hpp"
+#include "globals.hpp"
+#include "render.hpp"
+
+// Work that is done once per drawn cell, so the numbers read as CPU time saved per cell and frame
+static constexpr int ITERATIONS = 1000;
+
+struct HTBenchResult {
+    std::string name;
+    double old_ns;
+    double new_ns;
+};
+
+template<typename Fn>
+static double time_ns(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++)
+        fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+}
+
+// What rendering a non-active workspace cost before HTWorkspaceRenderScope: an in-animation to
+// draw it and an out-animation to hide it again, on every cell of every frame. The actual
+// renderWorkspace call is the same on both paths and left out.
+static HTBenchResult bench_workspace_scope(PHLMONITOR monitor, PHLWORKSPACE workspace) {
+    const PHLWORKSPACE active = monitor->m_activeWorkspace;
+
+    const double old_ns = time_ns([&] {
+        monitor->m_activeWorkspace = workspace;
+        g_pDesktopAnimationManager->startAnimation(
+            workspace,
+            CDesktopAnimationManager::ANIMATION_TYPE_IN,
+            false,
+            true
+        );
+        workspace->m_visible = true;
+        g_pDesktopAnimationManager->startAnimation(
+            workspace,
+            CDesktopAnimationManager::ANIMATION_TYPE_OUT,
+            false,
+            true
+        );
+        workspace->m_visible = false;
+        monitor->m_activeWorkspace = active;
+    });
+    // Leave no running animation behind, the scope below warps the rest
+    workspace->m_alpha->warp();
+    workspace->m_renderOffset->warp();
+
+    const double new_ns = time_ns([&] { HTWorkspaceRenderScope scope(monitor, workspace); });
+
+    return {"workspace_render_scope", old_ns, new_ns};
+}
+
+// Reading an option on a hot path: a lookup by name in a map of CConfigValue, as every option read
+// did before the snapshot, against a field of the snapshot
+static HTBenchResult bench_config_access() {
+    volatile float sink = 0.f;
+    const double old_ns = time_ns([&] { sink = HTConfig::value<Config::FLOAT>("gap_size"); });
+    const double new_ns = time_ns([&] { sink = HTConfig::snapshot().gap_size; });
+    (void)sink;
+    return {"config_access", old_ns, new_ns};
+}
+
+std::string run_bench(PHLMONITOR monitor, bool json) {
+    if (monitor == nullptr)
+        return "no monitor";
+
+    PHLWORKSPACE hidden = nullptr;
+    for (const PHLWORKSPACE& workspace : g_pCompositor->getWorkspacesCopy()) {
+        if (workspace != nullptr && workspace->monitorID() == monitor->m_id
+            && workspace->m_id > 0 && !workspace->m_visible) {
+            hidden = workspace;
+            break;
+        }
+    }
+
+    std::vector<HTBenchResult> results;
+    results.push_back(bench_config_access());
+
+    // Starting and warping animations damages the monitor, which is not client damage
+    const bool was_blocking = ht_manager->block_damage_reporting;
+    ht_manager->block_damage_reporting = true;
+    if (hidden != nullptr)
+        results.push_back(bench_workspace_scope(monitor, hidden));
+    ht_manager->block_damage_reporting = was_blocking;
+
+    std::string result = json ? "[" : "";
+    bool first = true;
+    for (const HTBenchResult& r : results) {
+        if (json) {
+            result += std::format(
+                "{}{{\"name\": \"{}\", \"iterations\": {}, \"old_ns\": {:.1f}, \"new_ns\": {:.1f}}}",
+                first ? "" : ", ",
+                r.name,
+                ITERATIONS,
+                r.old_ns,
+                r.new_ns
+            );
+        } else {
+            result += std::format(
+                "{}: old {:.1f} ns, new {:.1f} ns, saved {:.1f} ns per call ({} iterations)\n",
+                r.name,
+                r.old_ns,
+                r.new_ns,
+                r.old_ns - r.new_ns,
+                ITERATIONS
+            );
+        }
+        first = false;
+    }
+    if (json)
+        result += "]";
+    return result;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+
+// Times the per-frame CPU work that hyprtasking replaced against what it does now, on monitor.
+// Printed by `hyprctl hyprtasking:bench`.
+std::string run_bench(PHLMONITOR monitor, bool json);
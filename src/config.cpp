@@ -0,0 +1,125 @@
+#include "config.hpp"
+
+namespace HTConfig {
+
+template<typename T>
+struct HTOption: CConfigValue<T> {
+    HTOption(const std::string& name) : CConfigValue<T>("plugin:hyprtasking:" + name) {}
+};
+
+// Every option, looked up by name once. They read Hyprland's current values, so they also see
+// changes made with hyprctl keyword.
+struct HTConfigHandles {
+    HTOption<Config::STRING> layout {"layout"};
+
+    HTOption<Config::INTEGER> bg_color {"bg_color"};
+    HTOption<Config::FLOAT> gap_size {"gap_size"};
+    HTOption<Config::FLOAT> border_size {"border_size"};
+    HTOption<Config::INTEGER> hover_border_color {"hover_border_color"};
+    HTOption<Config::INTEGER> flat_borders {"flat_borders"};
+    HTOption<Config::FLOAT> thumbnail_budget_ms {"thumbnail_budget_ms"};
+    HTOption<Config::INTEGER> exit_on_hovered {"exit_on_hovered"};
+    HTOption<Config::INTEGER> warp_on_move_window {"warp_on_move_window"};
+    HTOption<Config::INTEGER> close_overview_on_reload {"close_overview_on_reload"};
+
+    HTOption<Config::INTEGER> drag_button {"drag_button"};
+    HTOption<Config::INTEGER> select_button {"select_button"};
+
+    HTOption<Config::INTEGER> gestures_enabled {"gestures:enabled"};
+    HTOption<Config::INTEGER> gestures_move_fingers {"gestures:move_fingers"};
+    HTOption<Config::FLOAT> gestures_move_distance {"gestures:move_distance"};
+    HTOption<Config::INTEGER> gestures_open_fingers {"gestures:open_fingers"};
+    HTOption<Config::FLOAT> gestures_open_distance {"gestures:open_distance"};
+    HTOption<Config::INTEGER> gestures_open_positive {"gestures:open_positive"};
+
+    HTOption<Config::INTEGER> grid_rows {"grid:rows"};
+    HTOption<Config::INTEGER> grid_cols {"grid:cols"};
+    HTOption<Config::INTEGER> grid_layers {"grid:layers"};
+    HTOption<Config::INTEGER> grid_loop_layers {"grid:loop_layers"};
+    HTOption<Config::INTEGER> grid_loop {"grid:loop"};
+    HTOption<Config::INTEGER> grid_gaps_use_aspect_ratio {"grid:gaps_use_aspect_ratio"};
+    HTOption<Config::FLOAT> grid_lod_simple_width {"grid:lod_simple_width"};
+    HTOption<Config::FLOAT> grid_lod_placeholder_width {"grid:lod_placeholder_width"};
+    HTOption<Config::INTEGER> grid_lod_placeholder_color {"grid:lod_placeholder_color"};
+
+    HTOption<Config::INTEGER> linear_blur {"linear:blur"};
+    HTOption<Config::FLOAT> linear_height {"linear:height"};
+    HTOption<Config::FLOAT> linear_scroll_speed {"linear:scroll_speed"};
+    HTOption<Config::INTEGER> linear_top {"linear:top"};
+    HTOption<Config::INTEGER> linear_frozen_background {"linear:frozen_background"};
+
+    HTOption<Config::FLOAT> minimap_width {"minimap:width"};
+    HTOption<Config::INTEGER> minimap_cols {"minimap:cols"};
+    HTOption<Config::INTEGER> minimap_corner {"minimap:corner"};
+    HTOption<Config::FLOAT> minimap_refresh_rate {"minimap:refresh_rate"};
+
+    HTOption<Config::INTEGER> prewarm_enabled {"prewarm:enabled"};
+    HTOption<Config::INTEGER> prewarm_workspaces {"prewarm:workspaces"};
+    HTOption<Config::FLOAT> prewarm_refresh_rate {"prewarm:refresh_rate"};
+    HTOption<Config::FLOAT> prewarm_vram_mb {"prewarm:vram_mb"};
+};
+
+bool reload_snapshot() {
+    // The options are registered before the first reload
+    static const HTConfigHandles h;
+    // Filled every frame, only copied out when an option changed
+    static HTConfigSnapshot next;
+
+    next.layout = *h.layout;
+
+    next.bg_color = *h.bg_color;
+    next.gap_size = *h.gap_size;
+    next.border_size = *h.border_size;
+    next.hover_border_color = *h.hover_border_color;
+    next.flat_borders = *h.flat_borders;
+    next.thumbnail_budget_ms = *h.thumbnail_budget_ms;
+    next.exit_on_hovered = *h.exit_on_hovered;
+    next.warp_on_move_window = *h.warp_on_move_window;
+    next.close_overview_on_reload = *h.close_overview_on_reload;
+
+    next.drag_button = *h.drag_button;
+    next.select_button = *h.select_button;
+
+    next.gestures.enabled = *h.gestures_enabled;
+    next.gestures.move_fingers = *h.gestures_move_fingers;
+    next.gestures.move_distance = *h.gestures_move_distance;
+    next.gestures.open_fingers = *h.gestures_open_fingers;
+    next.gestures.open_distance = *h.gestures_open_distance;
+    next.gestures.open_positive = *h.gestures_open_positive;
+
+    next.grid.rows = *h.grid_rows;
+    next.grid.cols = *h.grid_cols;
+    next.grid.layers = *h.grid_layers;
+    next.grid.loop_layers = *h.grid_loop_layers;
+    next.grid.loop = *h.grid_loop;
+    next.grid.gaps_use_aspect_ratio = *h.grid_gaps_use_aspect_ratio;
+    next.grid.lod_simple_width = *h.grid_lod_simple_width;
+    next.grid.lod_placeholder_width = *h.grid_lod_placeholder_width;
+    next.grid.lod_placeholder_color = *h.grid_lod_placeholder_color;
+
+    next.linear.blur = *h.linear_blur;
+    next.linear.height = *h.linear_height;
+    next.linear.scroll_speed = *h.linear_scroll_speed;
+    next.linear.top = *h.linear_top;
+    next.linear.frozen_background = *h.linear_frozen_background;
+
+    next.minimap.width = *h.minimap_width;
+    next.minimap.cols = *h.minimap_cols;
+    next.minimap.corner = *h.minimap_corner;
+    next.minimap.refresh_rate = *h.minimap_refresh_rate;
+
+    next.prewarm.enabled = *h.prewarm_enabled;
+    next.prewarm.workspaces = *h.prewarm_workspaces;
+    next.prewarm.refresh_rate = *h.prewarm_refresh_rate;
+    next.prewarm.vram_mb = *h.prewarm_vram_mb;
+
+    if (next.options() == current_snapshot->options())
+        return false;
+
+    next.hover_border_gradient =
+        Config::CGradientValueData {CHyprColor {next.hover_border_color}};
+    current_snapshot = std::make_shared<const HTConfigSnapshot>(next);
+    return true;
+}
+
+} // namespace HTConfig
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <tuple>
+
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprland/src/config/ConfigValue.hpp>
 #include <hyprland/src/config/ConfigManager.hpp>
@@ -24,4 +28,113 @@ inline T value(std::string config) {
     return *cache[config];
 }
 
+// Typed copy of every plugin option, so hot paths read plain fields instead of looking options up
+// by name. HTConfig::value is the old by-name lookup, kept for hyprtasking:bench.
+struct HTConfigSnapshot {
+    std::string layout = "grid";
+
+    int64_t bg_color = 0x000000FF;
+    float gap_size = 8.f;
+    float border_size = 4.f;
+    int64_t hover_border_color = 0x66ffffff;
+    // Built from hover_border_color, borders reference it instead of building one per frame
+    Config::CGradientValueData hover_border_gradient {CHyprColor {0x66ffffff}};
+    bool flat_borders = false;
+    float thumbnail_budget_ms = 3.f;
+    bool exit_on_hovered = false;
+    bool warp_on_move_window = true;
+    bool close_overview_on_reload = true;
+
+    unsigned int drag_button = 0;
+    unsigned int select_button = 0;
+
+    struct HTGesturesOptions {
+        bool enabled = true;
+        unsigned int move_fingers = 3;
+        float move_distance = 300.f;
+        unsigned int open_fingers = 4;
+        float open_distance = 300.f;
+        bool open_positive = true;
+
+        bool operator==(const HTGesturesOptions&) const = default;
+    } gestures;
+
+    struct HTGridOptions {
+        int rows = 3;
+        int cols = 3;
+        int layers = 1;
+        bool loop_layers = true;
+        bool loop = false;
+        bool gaps_use_aspect_ratio = false;
+        float lod_simple_width = 240.f;
+        float lod_placeholder_width = 0.f;
+        int64_t lod_placeholder_color = 0x40ffffff;
+
+        bool operator==(const HTGridOptions&) const = default;
+    } grid;
+
+    struct HTLinearOptions {
+        bool blur = true;
+        float height = 300.f;
+        float scroll_speed = 1.f;
+        bool top = false;
+        bool frozen_background = false;
+
+        bool operator==(const HTLinearOptions&) const = default;
+    } linear;
+
+    struct HTMinimapOptions {
+        float width = 320.f;
+        int cols = 3;
+        int corner = 3;
+        float refresh_rate = 4.f;
+
+        bool operator==(const HTMinimapOptions&) const = default;
+    } minimap;
+
+    struct HTPrewarmOptions {
+        bool enabled = false;
+        int workspaces = 4;
+        float refresh_rate = 1.f;
+        float vram_mb = 64.f;
+
+        bool operator==(const HTPrewarmOptions&) const = default;
+    } prewarm;
+
+    // Every option, hover_border_gradient is derived from hover_border_color
+    auto options() const {
+        return std::tie(
+            layout,
+            bg_color,
+            gap_size,
+            border_size,
+            hover_border_color,
+            flat_borders,
+            thumbnail_budget_ms,
+            exit_on_hovered,
+            warp_on_move_window,
+            close_overview_on_reload,
+            drag_button,
+            select_button,
+            gestures,
+            grid,
+            linear,
+            minimap,
+            prewarm
+        );
+    }
+};
+
+inline std::shared_ptr<const HTConfigSnapshot> current_snapshot =
+    std::make_shared<const HTConfigSnapshot>();
+
+// The options as of the last reload_snapshot
+inline const HTConfigSnapshot& snapshot() {
+    return *current_snapshot;
+}
+
+// Read every option and swap in a new snapshot if any changed, returns whether one did. Called on
+// init, config reload and before every frame, hyprctl keyword changes options without a reload.
+bool reload_snapshot();
+
 } // namespace HTConfig
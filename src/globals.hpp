@@ -16,6 +16,8 @@ inline HANDLE PHANDLE = nullptr;
 inline CFunctionHook* render_workspace_hook = nullptr;
 inline CFunctionHook* should_render_window_hook = nullptr;
 inline CFunctionHook* is_solitary_blocked_hook = nullptr;
+inline CFunctionHook* add_damage_box_hook = nullptr;
+inline CFunctionHook* add_damage_region_hook = nullptr;
 typedef uint32_t (*origIsSolitaryBlocked)(void*, bool);
 inline void* render_window = nullptr;
 
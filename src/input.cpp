@@ -17,6 +17,7 @@ bool HTManager::start_window_drag() {
     if (cursor_monitor == nullptr || cursor_view == nullptr || !cursor_view->active
         || cursor_view->closing)
         return false;
+    cursor_view->wake();
 
     if (!cursor_view->layout->should_manage_mouse()) {
         // hide all views if should not manage mouse but active
@@ -49,6 +50,7 @@ bool HTManager::start_window_drag() {
 
     const PHLWINDOW dragged_window = target->window();
     if (dragged_window != nullptr) {
+        drag_preview.start(dragged_window);
         if (g_layoutManager->dragController()->draggingTiled()) {
             const Vector2D pre_pos = cursor_view->layout->local_ws_unscaled_to_global(
                 dragged_window->m_realPosition->value() - dragged_window->m_monitor->m_position,
@@ -77,6 +79,8 @@ bool HTManager::start_window_drag() {
 }
 
 bool HTManager::end_window_drag() {
+    drag_preview.stop();
+
     const PHLMONITOR cursor_monitor = g_pCompositor->getMonitorFromCursor();
     const PHTVIEW cursor_view = get_view_from_monitor(cursor_monitor);
     if (cursor_monitor == nullptr || cursor_view == nullptr) {
@@ -89,6 +93,7 @@ bool HTManager::end_window_drag() {
         g_pKeybindManager->changeMouseBindMode(MBIND_INVALID);
         return false;
     }
+    cursor_view->wake();
 
     // For linear layout: if dropping on big workspace, just pass on
     if (!cursor_view->layout->should_manage_mouse()) {
@@ -182,9 +187,17 @@ bool HTManager::exit_to_workspace() {
     if (cursor_view == nullptr)
         return false;
 
-    if (!cursor_view->active || !cursor_view->layout->should_manage_mouse())
+    if (!cursor_view->layout->should_manage_mouse())
         return false;
 
+    // A layout drawn while closed (the minimap) switches to the clicked cell without opening
+    if (!cursor_view->active) {
+        if (!cursor_view->layout->shown_when_closed())
+            return false;
+        cursor_view->do_exit_behavior(true);
+        return true;
+    }
+
     for (PHTVIEW view : views) {
         if (view == nullptr)
             continue;
@@ -194,6 +207,31 @@ bool HTManager::exit_to_workspace() {
 }
 
 bool HTManager::on_mouse_move() {
+    if (CHyprColor {HTConfig::snapshot().hover_border_color}.a <= 0)
+        return false;
+
+    const PHTVIEW cursor_view = get_view_from_cursor();
+    const VIEWID cursor_view_id = cursor_view == nullptr ? -1 : cursor_view->monitor_id;
+    // The pointer left the monitor of the last hover, drop its highlight
+    if (hover_view_id != cursor_view_id) {
+        if (const PHTVIEW old_view = get_view_from_id(hover_view_id); old_view != nullptr)
+            old_view->layout->clear_hover();
+        hover_view_id = cursor_view_id;
+    }
+    if (cursor_view == nullptr)
+        return false;
+
+    if (!cursor_view->active || cursor_view->closing) {
+        cursor_view->layout->clear_hover();
+        return false;
+    }
+
+    const WORKSPACEID old_ws_id = cursor_view->layout->hovered_ws_id;
+    const PHLWINDOWREF old_window = cursor_view->layout->hovered_window;
+    cursor_view->layout->update_hover(g_pInputManager->getMouseCoordsInternal());
+    if (cursor_view->layout->hovered_ws_id != old_ws_id
+        || cursor_view->layout->hovered_window != old_window)
+        cursor_view->wake();
     return false;
 }
 
@@ -201,6 +239,7 @@ bool HTManager::on_mouse_axis(double delta) {
     const PHTVIEW cursor_view = get_view_from_cursor();
     if (cursor_view == nullptr)
         return false;
+    cursor_view->wake();
 
     return cursor_view->layout->on_mouse_axis(delta);
 }
@@ -208,6 +247,18 @@ bool HTManager::on_mouse_axis(double delta) {
 void HTManager::swipe_start() {
     swipe_state = HT_SWIPE_NONE;
     swipe_amt = 0.0;
+
+    if (!HTConfig::snapshot().gestures.enabled || !HTConfig::snapshot().prewarm.enabled)
+        return;
+
+    // The swipe may open the overview before another frame of the closed one, warm its
+    // thumbnails now (within thumbnail_budget_ms) instead of waiting for prewarm:refresh_rate
+    const PHLMONITOR cursor_monitor = g_pCompositor->getMonitorFromCursor();
+    const PHTVIEW cursor_view = get_view_from_monitor(cursor_monitor);
+    if (cursor_view == nullptr || cursor_view->active || cursor_view->navigating)
+        return;
+    cursor_view->layout->request_prewarm();
+    cursor_view->layout->prewarm(cursor_monitor, Time::steadyNow());
 }
 
 bool HTManager::swipe_update(IPointer::SSwipeUpdateEvent e) {
@@ -216,14 +267,15 @@ bool HTManager::swipe_update(IPointer::SSwipeUpdateEvent e) {
     if (cursor_view == nullptr)
         return false;
 
-    const int ENABLED = HTConfig::value<Config::INTEGER>("gestures:enabled");
+    const int ENABLED = HTConfig::snapshot().gestures.enabled;
     if (!ENABLED)
         return false;
+    cursor_view->wake();
 
-    const unsigned int MOVE_FINGERS = HTConfig::value<Config::INTEGER>("gestures:move_fingers");
-    const float OPEN_DISTANCE = HTConfig::value<Config::FLOAT>("gestures:open_distance");
-    const unsigned int OPEN_FINGERS = HTConfig::value<Config::INTEGER>("gestures:open_fingers");
-    const int OPEN_POSITIVE = HTConfig::value<Config::INTEGER>("gestures:open_positive");
+    const unsigned int MOVE_FINGERS = HTConfig::snapshot().gestures.move_fingers;
+    const float OPEN_DISTANCE = HTConfig::snapshot().gestures.open_distance;
+    const unsigned int OPEN_FINGERS = HTConfig::snapshot().gestures.open_fingers;
+    const int OPEN_POSITIVE = HTConfig::snapshot().gestures.open_positive;
 
     bool res = false;
     char swipe_direction = 0;
@@ -257,6 +309,8 @@ bool HTManager::swipe_update(IPointer::SSwipeUpdateEvent e) {
             swipe_amt += deltaY;
             const float swipe_perc = 1.0 - std::clamp(swipe_amt / OPEN_DISTANCE, 0.01f, 1.0f);
             cursor_view->layout->close_open_lerp(swipe_perc);
+            // Warped values are not animating, so the render path will not damage for us
+            damage_monitor(cursor_monitor);
         }
     } else if (e.fingers == MOVE_FINGERS) {
         if (swipe_state == HT_SWIPE_MOVE)
@@ -271,13 +325,14 @@ bool HTManager::swipe_update(IPointer::SSwipeUpdateEvent e) {
 
                 cursor_view->layout->init_position();
                 // need to schedule frames for monitor, otherwise the screen doesn't re-render
-                g_pHyprRenderer->damageMonitor(cursor_monitor);
+                damage_monitor(cursor_monitor);
                 g_pCompositor->scheduleFrameForMonitor(cursor_monitor);
             }
         }
 
         if (swipe_state == HT_SWIPE_MOVE) {
             cursor_view->layout->on_move_swipe(e.delta);
+            damage_monitor(cursor_monitor);
         }
     }
     return res;
@@ -290,7 +345,7 @@ bool HTManager::swipe_end() {
 
     switch (swipe_state) {
         case HT_SWIPE_OPEN: {
-            const float OPEN_DISTANCE = HTConfig::value<Config::FLOAT>("gestures:open_distance");
+            const float OPEN_DISTANCE = HTConfig::snapshot().gestures.open_distance;
             const float swipe_perc = 1.0 - std::clamp(swipe_amt / OPEN_DISTANCE, 0.01f, 1.0f);
             if (swipe_perc >= 0.5) {
                 cursor_view->show(false);
@@ -1,6 +1,9 @@
 #include "grid.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
 #include <unordered_set>
 
 #include <hyprland/src/Compositor.hpp>
@@ -9,15 +12,14 @@
 #include <hyprland/src/desktop/DesktopTypes.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
 #include <hyprland/src/managers/animation/AnimationManager.hpp>
-#include <hyprland/src/managers/animation/DesktopAnimationManager.hpp>
 #include <hyprland/src/config/shared/animation/AnimationTree.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
 #include <hyprland/src/config/shared/workspace/WorkspaceRuleManager.hpp>
 #include <hyprland/src/layout/LayoutManager.hpp>
 #include <hyprland/src/render/OpenGL.hpp>
 #include <hyprland/src/render/Renderer.hpp>
-#include <hyprland/src/render/pass/BorderPassElement.hpp>
 #include <hyprland/src/render/pass/RectPassElement.hpp>
+#include <hyprland/src/render/pass/TexPassElement.hpp>
 #include <hyprutils/math/Vector2D.hpp>
 #include <hyprutils/utils/ScopeGuard.hpp>
 
@@ -30,6 +32,9 @@
 
 using Hyprutils::Utils::CScopeGuard;
 
+static_assert(std::is_same_v<HTGridSlots::WsId, WORKSPACEID>);
+static_assert(HTGridSlots::INVALID == WORKSPACE_INVALID);
+
 HTLayoutGrid::HTLayoutGrid(VIEWID new_view_id) : HTLayoutBase(new_view_id) {
     auto &anim_tree = Config::animationTree();
     g_pAnimationManager->createAnimation(
@@ -45,21 +50,69 @@ HTLayoutGrid::HTLayoutGrid(VIEWID new_view_id) : HTLayoutBase(new_view_id) {
         AVARDAMAGE_NONE
     );
 
+    slots.is_pinned = [](WORKSPACEID ws_id) { return ht_manager->is_rule_ws(ws_id); };
     refresh_workspace_cache();
     init_position();
 }
 
-// Bit layout: [layer:24][y:20][x:20]. Used purely as an unordered_map key;
-// limits are implicit and not enforced (grid dims are not validated).
-long long HTLayoutGrid::pack_slot(int layer, int x, int y) {
-    return ((long long)layer << 40) | ((long long)(uint32_t)y << 20) | (long long)(uint32_t)x;
+void HTLayoutGrid::rebuild_index() {
+    HTLayoutBase::rebuild_index();
+
+    // Every cell has the same size and spacing, so the pitch follows from two of them
+    const HTViewStage stage = current_layout_stage();
+    index_origin = calculate_ws_box(0, 0, stage).pos();
+    index_pitch = calculate_ws_box(1, 1, stage).pos() - index_origin;
+}
+
+void HTLayoutGrid::swap_stage(HTViewStage stage) {
+    HTLayoutBase::swap_stage(stage);
+    std::swap(index_origin, stage_index_grid[stage].first);
+    std::swap(index_pitch, stage_index_grid[stage].second);
+}
+
+WORKSPACEID HTLayoutGrid::find_ws_at(Vector2D pos) {
+    if (index_pitch.x <= 0 || index_pitch.y <= 0)
+        return HTLayoutBase::find_ws_at(pos);
+
+    const int cell_x = std::floor((pos.x - index_origin.x) / index_pitch.x);
+    const int cell_y = std::floor((pos.y - index_origin.y) / index_pitch.y);
+
+    // Boxes are rounded, with small gaps a point can land in a neighbour of the computed cell
+    static constexpr std::array<std::pair<int, int>, 9> CANDIDATES = {{
+        {0, 0},
+        {-1, 0},
+        {1, 0},
+        {0, -1},
+        {0, 1},
+        {-1, -1},
+        {1, -1},
+        {-1, 1},
+        {1, 1},
+    }};
+    for (const auto& [dx, dy] : CANDIDATES) {
+        const WORKSPACEID ws_id = get_ws_id_from_xy(cell_x + dx, cell_y + dy);
+        if (ws_id == WORKSPACE_INVALID)
+            continue;
+        if (overview_layout.at(ws_id).box.containsPoint(pos))
+            return ws_id;
+    }
+    return WORKSPACE_INVALID;
 }
 
 WORKSPACEID HTLayoutGrid::slot_workspace(int layer, int x, int y) {
-    const auto it = slot_ws_cache.find(pack_slot(layer, x, y));
-    if (it == slot_ws_cache.end())
-        return WORKSPACE_INVALID;
-    return it->second;
+    return slots.at(layer, x, y);
+}
+
+bool HTLayoutGrid::assign_workspace(WORKSPACEID ws_id) {
+    return slots.assign(ws_id);
+}
+
+void HTLayoutGrid::on_workspace_removed(WORKSPACEID ws_id) {
+    slots.remove(ws_id);
+}
+
+void HTLayoutGrid::release_workspace(WORKSPACEID ws_id, WORKSPACEID synthetic_id) {
+    slots.release(ws_id, synthetic_id);
 }
 
 void HTLayoutGrid::refresh_workspace_cache(
@@ -69,38 +122,26 @@ void HTLayoutGrid::refresh_workspace_cache(
     if (monitor == nullptr)
         return;
 
-    const int ROWS = HTConfig::value<Config::INTEGER>("grid:rows");
-    const int COLS = HTConfig::value<Config::INTEGER>("grid:cols");
-    const int LAYERS = HTConfig::value<Config::INTEGER>("grid:layers");
+    const int ROWS = HTConfig::snapshot().grid.rows;
+    const int COLS = HTConfig::snapshot().grid.cols;
+    const int LAYERS = HTConfig::snapshot().grid.layers;
     if (ROWS <= 0 || COLS <= 0 || LAYERS <= 0)
         return;
 
-    const auto prior = ws_slot_cache;
-
-    ws_slot_cache.clear();
-    slot_ws_cache.clear();
-
-    std::vector<HTGridSlot> slots;
-    slots.reserve((size_t)LAYERS * ROWS * COLS);
-    for (int l = 0; l < LAYERS; l++)
-        for (int y = 0; y < ROWS; y++)
-            for (int x = 0; x < COLS; x++)
-                slots.push_back(HTGridSlot {l, x, y});
+    const auto prior = slots.slots();
+    slots.reset(LAYERS, ROWS, COLS);
 
     std::vector<bool> taken(slots.size(), false);
 
+    std::unordered_set<WORKSPACEID> live_ids;
     auto place = [&](WORKSPACEID id, size_t slot_idx) {
-        const HTGridSlot& s = slots[slot_idx];
-        ws_slot_cache[id] = s;
-        slot_ws_cache[pack_slot(s.layer, s.x, s.y)] = id;
+        slots.set(slot_idx, id, live_ids.contains(id));
         taken[slot_idx] = true;
     };
 
+    // Prior slots from a grid of other dimensions may be out of range now
     auto find_slot_index = [&](const HTGridSlot& s) -> long long {
-        for (size_t i = 0; i < slots.size(); i++)
-            if (slots[i].layer == s.layer && slots[i].x == s.x && slots[i].y == s.y)
-                return (long long)i;
-        return -1;
+        return slots.index(s.layer, s.x, s.y);
     };
 
     auto next_free_slot = [&](size_t& cursor) -> long long {
@@ -112,7 +153,7 @@ void HTLayoutGrid::refresh_workspace_cache(
     };
 
     auto place_with_prior = [&](WORKSPACEID id, size_t& cursor) -> bool {
-        if (ws_slot_cache.count(id))
+        if (slots.contains(id))
             return false;
         const auto pit = prior.find(id);
         if (pit != prior.end()) {
@@ -133,64 +174,59 @@ void HTLayoutGrid::refresh_workspace_cache(
     // could silently switch monitors. extra_off_limits carries IDs already
     // claimed by sibling views in this refresh.
     std::unordered_set<WORKSPACEID> off_limits = extra_off_limits;
-    const auto& ws_manager = Config::workspaceRuleMgr();
-    const auto& all_rules = ws_manager->getAllWorkspaceRules();
-    for (const auto& rule : all_rules) {
-        if (rule.m_workspaceId > 0)
-            off_limits.insert(rule.m_workspaceId);
-    }
-    for (const auto& w : g_pCompositor->getWorkspacesCopy()) {
-        if (w == nullptr)
-            continue;
-        if (w->monitorID() != view_id)
-            off_limits.insert(w->m_id);
-    }
-
-    size_t cursor = 0;
 
     // Sort by workspaceId so slot assignment doesn't depend on config-line order.
+    const auto& all_rules = Config::workspaceRuleMgr()->getAllWorkspaceRules();
     std::vector<const Config::CWorkspaceRule*> rules_sorted;
     rules_sorted.reserve(all_rules.size());
-    for (const auto& r : all_rules)
-        rules_sorted.push_back(&r);
+    for (const auto& rule : all_rules) {
+        if (rule.m_workspaceId <= 0)
+            continue;
+        off_limits.insert(rule.m_workspaceId);
+        rules_sorted.push_back(&rule);
+    }
     std::sort(rules_sorted.begin(), rules_sorted.end(),
               [](const Config::CWorkspaceRule* a, const Config::CWorkspaceRule* b) {
                   return a->m_workspaceId < b->m_workspaceId;
               });
 
-    for (const Config::CWorkspaceRule* rule : rules_sorted) {
-        if (rule->m_workspaceId <= 0)
-            continue;
-        if (extra_off_limits.count(rule->m_workspaceId))
-            continue;
-        const auto bound = Config::workspaceRuleMgr()->getBoundMonitorForWS(
-            rule->m_workspaceName.starts_with("name:")
-                ? rule->m_workspaceName.substr(5)
-                : rule->m_workspaceName
-        );
-        if (bound == nullptr || bound->m_id != view_id)
-            continue;
-        place_with_prior(rule->m_workspaceId, cursor);
-    }
-
     // Sort by m_id so slot assignment is independent of Hyprland's internal
     // m_workspaces vector order.
     std::vector<PHLWORKSPACE> on_monitor;
     for (const auto& w : g_pCompositor->getWorkspacesCopy()) {
         if (w == nullptr)
             continue;
-        if (w->monitorID() != view_id)
+        if (w->monitorID() != view_id) {
+            off_limits.insert(w->m_id);
             continue;
+        }
         if (w->m_id <= 0)
             continue;
         if (extra_off_limits.count(w->m_id))
             continue;
         on_monitor.push_back(w);
+        live_ids.insert(w->m_id);
     }
     std::sort(on_monitor.begin(), on_monitor.end(),
               [](const PHLWORKSPACE& a, const PHLWORKSPACE& b) {
                   return a->m_id < b->m_id;
               });
+
+    size_t cursor = 0;
+
+    for (const Config::CWorkspaceRule* rule : rules_sorted) {
+        if (extra_off_limits.count(rule->m_workspaceId))
+            continue;
+        const auto bound = Config::workspaceRuleMgr()->getBoundMonitorForWS(
+            rule->m_workspaceName.starts_with("name:")
+                ? rule->m_workspaceName.substr(5)
+                : rule->m_workspaceName
+        );
+        if (bound == nullptr || bound->m_id != view_id)
+            continue;
+        place_with_prior(rule->m_workspaceId, cursor);
+    }
+
     // Settle workspaces that still have a free prior slot before assigning
     // anyone via the cursor — otherwise a migrated workspace with no prior
     // here would steal slot 0 and displace this monitor's resident at (0,0).
@@ -212,7 +248,7 @@ void HTLayoutGrid::refresh_workspace_cache(
     WORKSPACEID synth_candidate = 1;
     auto next_synth = [&]() -> WORKSPACEID {
         while (true) {
-            if (off_limits.count(synth_candidate) || ws_slot_cache.count(synth_candidate)) {
+            if (off_limits.count(synth_candidate) || slots.contains(synth_candidate)) {
                 synth_candidate++;
                 continue;
             }
@@ -233,9 +269,9 @@ std::string HTLayoutGrid::layout_name() {
 }
 
 WORKSPACEID HTLayoutGrid::get_ws_id_in_direction(int x, int y, std::string& direction) {
-    const int LOOP = HTConfig::value<Config::INTEGER>("grid:loop");
-    const int ROWS = HTConfig::value<Config::INTEGER>("grid:rows");
-    const int COLS = HTConfig::value<Config::INTEGER>("grid:cols");
+    const int LOOP = HTConfig::snapshot().grid.loop;
+    const int ROWS = HTConfig::snapshot().grid.rows;
+    const int COLS = HTConfig::snapshot().grid.cols;
 
     if (direction == "up") {
         y--;
@@ -261,9 +297,9 @@ void HTLayoutGrid::on_move_swipe(Vector2D delta) {
     if (monitor == nullptr)
         return;
 
-    const float MOVE_DISTANCE = HTConfig::value<Config::FLOAT>("gestures:move_distance");
-    const int ROWS = HTConfig::value<Config::INTEGER>("grid:rows");
-    const int COLS = HTConfig::value<Config::INTEGER>("grid:cols");
+    const float MOVE_DISTANCE = HTConfig::snapshot().gestures.move_distance;
+    const int ROWS = HTConfig::snapshot().grid.rows;
+    const int COLS = HTConfig::snapshot().grid.cols;
     const CBox min_ws = calculate_ws_box(0, 0, HT_VIEW_CLOSED);
     const CBox max_ws = calculate_ws_box(COLS - 1, ROWS - 1, HT_VIEW_CLOSED);
 
@@ -303,7 +339,7 @@ void HTLayoutGrid::close_open_lerp(float perc) {
 
     build_overview_layout(HT_VIEW_CLOSED);
     double close_scale = 1.;
-    Vector2D close_pos = -overview_layout[monitor->m_activeWorkspace->m_id].box.pos();
+    Vector2D close_pos = -ws_layout(monitor->m_activeWorkspace->m_id).box.pos();
 
     double new_scale = std::lerp(close_scale, open_scale, perc);
     Vector2D new_pos = Vector2D {
@@ -345,7 +381,7 @@ void HTLayoutGrid::on_hide(CallbackFun on_complete) {
     build_overview_layout(HT_VIEW_CLOSED);
     *scale = 1.;
     // End workspace to end up on
-    *offset = -overview_layout[monitor->m_activeWorkspace->m_id].box.pos();
+    *offset = -ws_layout(monitor->m_activeWorkspace->m_id).box.pos();
 }
 
 void HTLayoutGrid::on_move(WORKSPACEID old_id, WORKSPACEID new_id, CallbackFun on_complete) {
@@ -365,31 +401,24 @@ void HTLayoutGrid::on_move(WORKSPACEID old_id, WORKSPACEID new_id, CallbackFun o
     build_overview_layout(HT_VIEW_CLOSED);
     *scale = 1.;
     // Target workspace to animate to
-    *offset = -overview_layout[new_id].box.pos();
+    *offset = -ws_layout(new_id).box.pos();
 }
 
-bool HTLayoutGrid::should_render_window(PHLWINDOW window) {
-    bool ori_result = HTLayoutBase::should_render_window(window);
-
-    const PHLMONITOR monitor = get_monitor();
-    if (window == nullptr || monitor == nullptr)
+bool HTLayoutGrid::should_render_window(PHLWINDOW window, bool ori_result) {
+    if (window == nullptr)
         return ori_result;
 
-    const SP<Layout::ITarget> target = g_layoutManager->dragController()->target();
-    if (target != nullptr && window == target->window())
+    if (is_dragged_window(window))
         return false;
 
-    PHLWORKSPACE workspace = window->m_workspace;
-    if (workspace == nullptr)
-        return false;
+    if (rendering_offscreen)
+        return ori_result;
 
-    CBox window_box = get_global_window_box(window, window->workspaceID());
-    if (window_box.empty())
-        return false;
-    if (window_box.intersection(monitor->logicalBox()).empty())
-        return false;
+    return ori_result && is_window_visible(window);
+}
 
-    return ori_result;
+bool HTLayoutGrid::is_animating() {
+    return scale->isBeingAnimated() || offset->isBeingAnimated();
 }
 
 float HTLayoutGrid::drag_window_scale() {
@@ -407,9 +436,8 @@ void HTLayoutGrid::init_position() {
     // Sync to the layer of whatever workspace is currently active on this
     // monitor. Fresh views (e.g. after monitor reconnect) start at layer 0,
     // so without this the overview would open on the wrong layer.
-    const auto sit = ws_slot_cache.find(monitor->m_activeWorkspace->m_id);
-    if (sit != ws_slot_cache.end())
-        layer = sit->second.layer;
+    if (const HTGridSlot* slot = slots.find(monitor->m_activeWorkspace->m_id); slot != nullptr)
+        layer = slot->layer;
 
     build_overview_layout(HT_VIEW_CLOSED);
 
@@ -430,10 +458,10 @@ CBox HTLayoutGrid::calculate_ws_box(int x, int y, HTViewStage stage) {
     if (monitor->m_transformedSize.x < 1 || monitor->m_transformedSize.y < 1)
         return {};
 
-    const int ROWS = HTConfig::value<Config::INTEGER>("grid:rows");
-    const int COLS = HTConfig::value<Config::INTEGER>("grid:cols");
-    const int GAPS_USE_ASPECT_RATIO = HTConfig::value<Config::INTEGER>("grid:gaps_use_aspect_ratio");
-    const float GAP_SIZE = HTConfig::value<Config::FLOAT>("gap_size") * monitor->m_scale;
+    const int ROWS = HTConfig::snapshot().grid.rows;
+    const int COLS = HTConfig::snapshot().grid.cols;
+    const int GAPS_USE_ASPECT_RATIO = HTConfig::snapshot().grid.gaps_use_aspect_ratio;
+    const float GAP_SIZE = HTConfig::snapshot().gap_size * monitor->m_scale;
     const Vector2D gaps = {
         GAP_SIZE,
         GAPS_USE_ASPECT_RATIO
@@ -478,8 +506,15 @@ void HTLayoutGrid::build_overview_layout(HTViewStage stage) {
     if (monitor == nullptr)
         return;
 
-    const int ROWS = HTConfig::value<Config::INTEGER>("grid:rows");
-    const int COLS = HTConfig::value<Config::INTEGER>("grid:cols");
+    HTLayoutKey key = base_layout_key(stage);
+    key.content_generation = slots.generation();
+    if (stage == HT_VIEW_ANIMATING)
+        key.animated = {scale->value(), offset->value().x, offset->value().y};
+    if (restore_cached_layout(key))
+        return;
+
+    const int ROWS = HTConfig::snapshot().grid.rows;
+    const int COLS = HTConfig::snapshot().grid.cols;
 
     const PHLMONITOR last_monitor = Desktop::focusState()->monitor();
     Desktop::focusState()->rawMonitorFocus(monitor);
@@ -496,10 +531,197 @@ void HTLayoutGrid::build_overview_layout(HTViewStage stage) {
         }
     }
 
+    store_cached_layout(key);
+
     if (last_monitor != nullptr)
         Desktop::focusState()->rawMonitorFocus(last_monitor);
 }
 
+Vector2D HTLayoutGrid::thumbnail_size(const CBox& ws_box) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return {};
+
+    // Render thumbnails at the opened cell size, and only at full size while a cell is zoomed
+    // in past that (opening, closing or navigating), so that 9+ thumbnails stay small
+    const CBox open_box = calculate_ws_box(0, 0, HT_VIEW_OPENED);
+    if (ws_box.w <= open_box.w * 1.05)
+        return Vector2D {std::round(open_box.w), std::round(open_box.h)};
+    return Vector2D {
+        std::round(monitor->m_transformedSize.x),
+        std::round(monitor->m_transformedSize.y)
+    };
+}
+
+HTRenderDetail HTLayoutGrid::cell_detail(double width) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return HT_DETAIL_FULL;
+
+    const double logical_width = width / monitor->m_scale;
+    if (logical_width < HTConfig::snapshot().grid.lod_placeholder_width)
+        return HT_DETAIL_PLACEHOLDER;
+    if (logical_width < HTConfig::snapshot().grid.lod_simple_width)
+        return HT_DETAIL_SIMPLE;
+    return HT_DETAIL_FULL;
+}
+
+std::optional<HTLayoutBase::HTThumbnailSpec> HTLayoutGrid::prewarm_spec() {
+    // Same as pre_render once the overview is open
+    const Vector2D size = thumbnail_size(calculate_ws_box(0, 0, HT_VIEW_OPENED));
+    return HTThumbnailSpec {size, cell_detail(size.x)};
+}
+
+void HTLayoutGrid::pre_render() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr || monitor->m_activeWorkspace == nullptr)
+        return;
+
+    const float BORDERSIZE = HTConfig::snapshot().border_size;
+    const auto time = Time::steadyNow();
+
+    rendering_offscreen = true;
+    CScopeGuard x([this] { rendering_offscreen = false; });
+
+    build_overview_layout(HT_VIEW_ANIMATING);
+
+    // The shared layer thumbnail has to be as large as the largest visible cell
+    Vector2D background_size;
+
+    CBox global_mon_box = {monitor->m_position, monitor->m_transformedSize};
+    for (const auto& [ws_id, ws_layout] : overview_layout) {
+        if (ws_layout.box.width < 0.01 || ws_layout.box.height < 0.01)
+            continue;
+        CBox global_box = {ws_layout.box.pos() + monitor->m_position, ws_layout.box.size()};
+        if (global_box.expand(BORDERSIZE).intersection(global_mon_box).empty())
+            continue;
+
+        const Vector2D size = thumbnail_size(ws_layout.box);
+        if (size.x > background_size.x)
+            background_size = size;
+
+        // The active workspace is always rendered live
+        if (ws_id == monitor->m_activeWorkspace->m_id)
+            continue;
+        // Synthetic slots only show the shared layers
+        if (g_pCompositor->getWorkspaceByID(ws_id) == nullptr)
+            continue;
+        // Placeholders are drawn directly, there is nothing to cache
+        const HTRenderDetail detail = cell_detail(size.x);
+        if (detail == HT_DETAIL_PLACEHOLDER)
+            continue;
+        if (!thumbnails.needs_refresh(ws_id, size, detail))
+            continue;
+        queue_thumbnail_refresh(ws_id, size, detail, ws_layout.box);
+    }
+
+    if (background_size.x >= 1 && thumbnails.background_needs_refresh(monitor, background_size))
+        thumbnails.refresh_background(monitor, background_size, time);
+
+    run_thumbnail_refreshes(monitor, time);
+}
+
+void HTLayoutGrid::render_cell(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const CBox& ws_box,
+    const CBox& render_box,
+    const Time::steady_tp& time
+) {
+    auto add_texture = [this, &ws_box](HTThumbnail* thumb) {
+        add_cell_texture(thumb->fb.getTexture(), ws_box);
+    };
+
+    HTThumbnail* background = thumbnails.find_background();
+    if (background == nullptr) {
+        // Nothing cached yet, render the layers with the workspace
+        render_workspace_at_box(monitor, workspace, time, render_box);
+        return;
+    }
+
+    // Wallpaper and bars are drawn once per monitor and shared by every cell
+    add_texture(background);
+    if (workspace == nullptr)
+        return;
+
+    const HTRenderDetail detail = cell_detail(ws_box.w);
+    if (detail == HT_DETAIL_PLACEHOLDER) {
+        render_workspace_placeholders(
+            monitor,
+            workspace,
+            ws_box,
+            CHyprColor {HTConfig::snapshot().grid.lod_placeholder_color}
+        );
+        return;
+    }
+
+    // Composite the cached contents, refreshed in pre_render if damaged
+    HTThumbnail* thumb =
+        workspace == monitor->m_activeWorkspace ? nullptr : thumbnails.find(workspace->m_id);
+    if (thumb != nullptr) {
+        add_texture(thumb);
+        return;
+    }
+
+    // Not rendered yet and out of budget, rendering it live would blow the budget anyway
+    if (workspace != monitor->m_activeWorkspace && is_refresh_deferred(workspace->m_id)) {
+        render_workspace_placeholders(
+            monitor,
+            workspace,
+            ws_box,
+            CHyprColor {HTConfig::snapshot().grid.lod_placeholder_color}
+        );
+        return;
+    }
+
+    HTLayerHideScope hide_layers(monitor);
+    if (detail == HT_DETAIL_SIMPLE)
+        render_workspace_windows_at_box(monitor, workspace, time, ws_box);
+    else
+        render_workspace_at_box(monitor, workspace, time, render_box);
+}
+
+void HTLayoutGrid::update_display_list(PHLMONITOR monitor) {
+    // Hyprland will only properly render the current active workspace, so the others are rendered
+    // through a HTWorkspaceRenderScope, see render_workspace_at_box
+    const PHLWORKSPACE start_workspace = monitor->m_activeWorkspace;
+
+    HTGridDisplayKey key;
+    key.layout = base_layout_key(HT_VIEW_ANIMATING);
+    key.layout.content_generation = slots.generation();
+    key.workspace_generation = ht_manager->workspace_generation;
+    key.active_ws_id = start_workspace == nullptr ? WORKSPACE_INVALID : start_workspace->m_id;
+    key.hovered_ws_id = is_hovered_ws(hovered_ws_id) ? hovered_ws_id : WORKSPACE_INVALID;
+    if (display_key == key) {
+        stats.display_list_hits++;
+        return;
+    }
+    stats.display_list_misses++;
+    display_key = key;
+
+    display_list.clear();
+    display_list.reserve(overview_layout.size());
+    for (const auto& [ws_id, ws_layout] : overview_layout) {
+        if (ws_id == key.active_ws_id)
+            continue;
+        display_list.push_back({
+            .ws_id = ws_id,
+            .workspace = g_pCompositor->getWorkspaceByID(ws_id),
+            .border = &cell_border_gradient(ws_id, false),
+        });
+    }
+
+    // Render active workspace last so the dragging window is always on top when let go of
+    if (key.active_ws_id != WORKSPACE_INVALID && overview_layout.contains(key.active_ws_id)) {
+        display_list.push_back({
+            .ws_id = key.active_ws_id,
+            .workspace = start_workspace,
+            .border = &cell_border_gradient(key.active_ws_id, true),
+            .active = true,
+        });
+    }
+}
+
 void HTLayoutGrid::render() {
     HTLayoutBase::render();
     CScopeGuard x([this] { post_render(); });
@@ -511,150 +733,54 @@ void HTLayoutGrid::render() {
     if (monitor == nullptr)
         return;
 
-    static auto PACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.active_border");
-    static auto PINACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
-
-    auto* const ACTIVECOL = (Config::CGradientValueData*)(PACTIVECOL.ptr());
-    auto* const INACTIVECOL = (Config::CGradientValueData*)(PINACTIVECOL.ptr());
-
-    const float BORDERSIZE = HTConfig::value<Config::FLOAT>("border_size");
+    const float BORDERSIZE = HTConfig::snapshot().border_size;
 
     const auto time = Time::steadyNow();
 
-
-    g_pHyprRenderer->damageMonitor(monitor);
     g_pHyprRenderer->m_renderData.pMonitor->m_blurFBShouldRender = true;
     CBox monitor_box = {{0, 0}, monitor->m_transformedSize};
 
     CRectPassElement::SRectData data;
-    data.color = CHyprColor {HTConfig::value<Config::INTEGER>("bg_color")}.stripA();
+    data.color = CHyprColor {HTConfig::snapshot().bg_color}.stripA();
     data.box = monitor_box;
     g_pHyprRenderer->m_renderPass.add(makeUnique<CRectPassElement>(data));
 
-    // Do a dance with active workspaces: Hyprland will only properly render the
-    // current active one so make the workspace active before rendering it, etc
-    const PHLWORKSPACE start_workspace = monitor->m_activeWorkspace;
-
-    g_pDesktopAnimationManager->startAnimation(
-        start_workspace,
-        CDesktopAnimationManager::ANIMATION_TYPE_OUT,
-        false,
-        true
-    );
-    start_workspace->m_visible = false;
-
     build_overview_layout(HT_VIEW_ANIMATING);
+    update_visible_windows();
+    update_display_list(monitor);
 
+    // Thumbnails of all cells go under everything rendered live in the loop
+    begin_texture_batch();
+    CScopeGuard end_batch([this] { end_texture_batch(); });
+
+    // Replay the display list, only the boxes come from this frame's (animated) layout
     CBox global_mon_box = {monitor->m_position, monitor->m_transformedSize};
-    for (const auto& [ws_id, ws_layout] : overview_layout) {
+    for (const HTGridDrawCell& cell : display_list) {
+        const auto it = overview_layout.find(cell.ws_id);
+        if (it == overview_layout.end())
+            continue;
+        const CBox& ws_box = it->second.box;
         // Skip if the box is empty
-        if (ws_layout.box.width < 0.01 || ws_layout.box.height < 0.01)
+        if (ws_box.width < 0.01 || ws_box.height < 0.01)
             continue;
 
-        // Could be nullptr, in which we render only layers
-        const PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByID(ws_id);
+        CBox global_box = {ws_box.pos() + monitor->m_position, ws_box.size()};
+        if (!cell.active && global_box.expand(BORDERSIZE).intersection(global_mon_box).empty())
+            continue;
 
         // renderModif translation used by renderWorkspace is weird so need
         // to scale the translation up as well. Geometry is also calculated from pixel size and not transformed size??
-        CBox render_box = {{ws_layout.box.pos() / scale->value()}, ws_layout.box.size()};
+        CBox render_box = {{ws_box.pos() / scale->value()}, ws_box.size()};
         if (monitor->m_transform % 2 == 1)
             std::swap(render_box.w, render_box.h);
 
-        // render active one last
-        if (workspace == start_workspace && start_workspace != nullptr)
-            continue;
-
-        CBox global_box = {ws_layout.box.pos() + monitor->m_position, ws_layout.box.size()};
-        if (global_box.expand(BORDERSIZE).intersection(global_mon_box).empty())
-            continue;
-
-        const Config::CGradientValueData border_col =
-            monitor->m_activeWorkspace->m_id == ws_id ? *ACTIVECOL : *INACTIVECOL;
-        CBox border_box = ws_layout.box;
-
-        CBorderPassElement::SBorderData data;
-        data.box = border_box;
-        data.grad1 = border_col;
-        data.borderSize = BORDERSIZE;
-
-        if (workspace != nullptr) {
-            monitor->m_activeWorkspace = workspace;
-            g_pDesktopAnimationManager->startAnimation(
-                workspace,
-                CDesktopAnimationManager::ANIMATION_TYPE_IN,
-                false,
-                true
-            );
-            workspace->m_visible = true;
-
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                workspace,
-                time,
-                render_box
-            );
-
-            g_pDesktopAnimationManager->startAnimation(
-                workspace,
-                CDesktopAnimationManager::ANIMATION_TYPE_OUT,
-                false,
-                true
-            );
-            workspace->m_visible = false;
-        } else {
-            // If pWorkspace is null, then just render the layers
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                workspace,
-                time,
-                render_box
-            );
-        }
-        g_pHyprRenderer->m_renderPass.add(makeUnique<CBorderPassElement>(data));
+        // Could be nullptr, in which we render only layers
+        render_cell(monitor, cell.workspace.lock(), ws_box, render_box, time);
+        render_cell_border(monitor, ws_box, *cell.border);
     }
+    add_flat_borders();
 
-    monitor->m_activeWorkspace = start_workspace;
-    g_pDesktopAnimationManager->startAnimation(
-        start_workspace,
-        CDesktopAnimationManager::ANIMATION_TYPE_IN,
-        false,
-        true
-    );
-    start_workspace->m_visible = true;
-
-    // Render active workspace last so the dragging window is always on top when let go of
-    if (start_workspace != nullptr && overview_layout.count(start_workspace->m_id)) {
-        CBox ws_box = overview_layout[start_workspace->m_id].box;
-        // make sure box is not empty
-        if (ws_box.width > 0.01 && ws_box.height > 0.01) {
-            // renderModif translation used by renderWorkspace is weird so need
-            // to scale the translation up as well. Geometry is also calculated from pixel size and not transformed size??
-            CBox render_box = {{ws_box.pos() / scale->value()}, ws_box.size()};
-            if (monitor->m_transform % 2 == 1)
-                std::swap(render_box.w, render_box.h);
-
-            const Config::CGradientValueData border_col =
-                monitor->m_activeWorkspace->m_id == start_workspace->m_id ? *ACTIVECOL
-                                                                          : *INACTIVECOL;
-            CBox border_box = ws_box;
-
-            CBorderPassElement::SBorderData data;
-            data.box = border_box;
-            data.grad1 = border_col;
-            data.borderSize = BORDERSIZE;
-
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                start_workspace,
-                time,
-                render_box
-            );
-            g_pHyprRenderer->m_renderPass.add(makeUnique<CBorderPassElement>(data));
-        }
-    }
+    render_hovered_window_border(monitor);
 
     const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
     if (cursor_view == nullptr)
@@ -671,5 +797,5 @@ void HTLayoutGrid::render() {
                                 .scale(cursor_view->layout->drag_window_scale())
                                 .translate(mouse_coords);
     if (!window_box.intersection(monitor->logicalBox()).empty())
-        render_window_at_box(dragged_window, monitor, time, window_box);
+        render_drag_window_at_box(dragged_window, monitor, time, window_box);
 }
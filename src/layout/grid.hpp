@@ -1,28 +1,73 @@
 #pragma once
 
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "../types.hpp"
+#include "grid_slots.hpp"
 #include "layout_base.hpp"
 
-struct HTGridSlot {
-    int layer;
-    int x;
-    int y;
-};
-
 class HTLayoutGrid: public HTLayoutBase {
   private:
     PHLANIMVAR<float> scale;
     PHLANIMVAR<Vector2D> offset;
 
-    // Survives workspace destruction so a slot stays sticky for an empty ws.
-    std::unordered_map<WORKSPACEID, HTGridSlot> ws_slot_cache;
-    std::unordered_map<long long, WORKSPACEID> slot_ws_cache;
+    // Survives workspace destruction so a slot stays sticky for an empty ws. Slots of workspace
+    // rule ids are never free, the rule keeps them.
+    HTGridSlots slots;
+
+    // Uniform grid over the cells of overview_layout: cell (x, y) starts at
+    // index_origin + (x, y) * index_pitch
+    Vector2D index_origin;
+    Vector2D index_pitch;
+    // index_origin and index_pitch of the other stages, see swap_stage
+    std::array<std::pair<Vector2D, Vector2D>, 3> stage_index_grid;
+
+    // Size of the thumbnail backing a cell currently drawn at ws_box
+    Vector2D thumbnail_size(const CBox& ws_box);
+    // Level of detail of a cell width pixels wide, see grid:lod_*
+    HTRenderDetail cell_detail(double width);
+    // One cell of the display list
+    struct HTGridDrawCell {
+        WORKSPACEID ws_id = WORKSPACE_INVALID;
+        // Expired for synthetic slots, which only show the layers
+        PHLWORKSPACEREF workspace;
+        const Config::CGradientValueData* border = nullptr;
+        // The active workspace is drawn last and never culled
+        bool active = false;
+    };
+    // Everything the display list depends on, besides the animated scale and offset
+    struct HTGridDisplayKey {
+        HTLayoutKey layout;
+        uint64_t workspace_generation = 0;
+        WORKSPACEID active_ws_id = WORKSPACE_INVALID;
+        WORKSPACEID hovered_ws_id = WORKSPACE_INVALID;
 
-    static long long pack_slot(int layer, int x, int y);
+        bool operator==(const HTGridDisplayKey&) const = default;
+    };
+    // Cells in render order with their workspace and border, replayed by render() with the boxes
+    // of the current layout. Only rebuilt when display_key changes.
+    std::vector<HTGridDrawCell> display_list;
+    std::optional<HTGridDisplayKey> display_key;
+    // Call once overview_layout is built for the frame
+    void update_display_list(PHLMONITOR monitor);
+
+    // Draw a cell from its thumbnails, or live if they are missing (and for the active workspace)
+    void render_cell(
+        PHLMONITOR monitor,
+        PHLWORKSPACE workspace,
+        const CBox& ws_box,
+        const CBox& render_box,
+        const Time::steady_tp& time
+    );
+
+  protected:
+    virtual void rebuild_index();
+    virtual void swap_stage(HTViewStage stage);
+    virtual WORKSPACEID find_ws_at(Vector2D pos);
 
   public:
     HTLayoutGrid(VIEWID view_id);
@@ -41,14 +86,27 @@ class HTLayoutGrid: public HTLayoutBase {
 
     virtual WORKSPACEID get_ws_id_in_direction(int x, int y, std::string& direction);
 
-    virtual bool should_render_window(PHLWINDOW window);
+    virtual bool should_render_window(PHLWINDOW window, bool ori_result);
+    virtual bool is_animating();
     virtual float drag_window_scale();
     virtual void init_position();
     virtual void build_overview_layout(HTViewStage stage);
     virtual void render();
+    virtual void pre_render();
+    virtual std::optional<HTThumbnailSpec> prewarm_spec();
 
     void refresh_workspace_cache(const std::unordered_set<WORKSPACEID>& extra_off_limits = {});
     WORKSPACEID slot_workspace(int layer, int x, int y);
+    bool has_workspace(WORKSPACEID ws_id) const { return slots.contains(ws_id); }
+
+    // Incremental updates between full refreshes, driven by workspace events (see HTManager).
+    // A workspace that now exists on this monitor takes its own slot, or the first free one.
+    // Returns false if the grid is full.
+    bool assign_workspace(WORKSPACEID ws_id);
+    // ws_id no longer exists, its slot stays sticky but can be taken by a new workspace
+    void on_workspace_removed(WORKSPACEID ws_id);
+    // ws_id left this monitor (or is claimed by another grid), its slot gets synthetic_id
+    void release_workspace(WORKSPACEID ws_id, WORKSPACEID synthetic_id);
 
-    const std::unordered_map<WORKSPACEID, HTGridSlot>& cache() const { return ws_slot_cache; }
+    const std::unordered_map<WORKSPACEID, HTGridSlot>& cache() const { return slots.slots(); }
 };
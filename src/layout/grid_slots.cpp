@@ -0,0 +1,80 @@
+#include "grid_slots.hpp"
+
+void HTGridSlots::reset(int new_layers, int new_rows, int new_cols) {
+    layers = new_layers;
+    rows = new_rows;
+    cols = new_cols;
+    ws_slots.clear();
+    slot_ws.assign((size_t)layers * rows * cols, INVALID);
+    free.clear();
+    slot_generation++;
+}
+
+long long HTGridSlots::index(int layer, int x, int y) const {
+    if (layer < 0 || x < 0 || y < 0 || layer >= layers || y >= rows || x >= cols)
+        return -1;
+    return ((long long)layer * rows + y) * cols + x;
+}
+
+void HTGridSlots::set(size_t index, WsId ws_id, bool live) {
+    const int per_layer = rows * cols;
+    const int layer = index / per_layer;
+    const int y = (index % per_layer) / cols;
+    const int x = index % cols;
+
+    slot_ws[index] = ws_id;
+    ws_slots[ws_id] = HTGridSlot {layer, x, y};
+    // A workspace rule pins its slot even before (and after) the workspace exists
+    if (live || pinned(ws_id))
+        free.erase(index);
+    else
+        free.insert(index);
+    slot_generation++;
+}
+
+HTGridSlots::WsId HTGridSlots::at(int layer, int x, int y) const {
+    const long long i = index(layer, x, y);
+    if (i < 0)
+        return INVALID;
+    return slot_ws[i];
+}
+
+const HTGridSlot* HTGridSlots::find(WsId ws_id) const {
+    const auto it = ws_slots.find(ws_id);
+    return it == ws_slots.end() ? nullptr : &it->second;
+}
+
+bool HTGridSlots::assign(WsId ws_id) {
+    if (const HTGridSlot* slot = find(ws_id); slot != nullptr) {
+        // Its sticky (or synthetic) slot now holds a real workspace
+        free.erase(index(slot->layer, slot->x, slot->y));
+        slot_generation++;
+        return true;
+    }
+
+    if (free.empty())
+        return false;
+
+    const size_t i = *free.begin();
+    ws_slots.erase(slot_ws[i]);
+    set(i, ws_id, true);
+    return true;
+}
+
+void HTGridSlots::remove(WsId ws_id) {
+    const HTGridSlot* slot = find(ws_id);
+    if (slot == nullptr || pinned(ws_id))
+        return;
+    free.insert(index(slot->layer, slot->x, slot->y));
+}
+
+void HTGridSlots::release(WsId ws_id, WsId synthetic_id) {
+    const auto it = ws_slots.find(ws_id);
+    if (it == ws_slots.end())
+        return;
+    const long long i = index(it->second.layer, it->second.x, it->second.y);
+    ws_slots.erase(it);
+    if (i >= 0)
+        set(i, synthetic_id, false);
+    slot_generation++;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Only depends on the standard library, so tests/ can build it without Hyprland
+
+struct HTGridSlot {
+    int layer;
+    int x;
+    int y;
+};
+
+// Workspace of every slot of a layers * rows * cols grid, and the slot of every workspace.
+// Slots of workspaces that do not exist (synthetic or destroyed) are free, new workspaces take the
+// first one. A destroyed workspace keeps its slot until then, so it stays sticky.
+class HTGridSlots {
+  public:
+    // Same type and invalid value as Hyprland's WORKSPACEID
+    using WsId = int64_t;
+    static constexpr WsId INVALID = -1;
+
+    // Ids bound by workspace rules, their slots are never free. Unset means none are.
+    std::function<bool(WsId)> is_pinned;
+
+    // Resize to an empty grid, no slot is free until set
+    void reset(int layers, int rows, int cols);
+    // Index of (layer, x, y), -1 if out of range
+    long long index(int layer, int x, int y) const;
+    size_t size() const { return slot_ws.size(); }
+    // live is whether ws_id is an existing workspace, else the slot is free
+    void set(size_t index, WsId ws_id, bool live);
+
+    // INVALID if out of range
+    WsId at(int layer, int x, int y) const;
+    bool contains(WsId ws_id) const { return ws_slots.contains(ws_id); }
+    // nullptr if ws_id has no slot
+    const HTGridSlot* find(WsId ws_id) const;
+    const std::unordered_map<WsId, HTGridSlot>& slots() const { return ws_slots; }
+    bool is_free(size_t index) const { return free.contains(index); }
+    // Bumped whenever a slot changes hands
+    uint64_t generation() const { return slot_generation; }
+
+    // ws_id now exists on this grid's monitor: it takes its own slot, or the first free one.
+    // Returns false if the grid is full.
+    bool assign(WsId ws_id);
+    // ws_id no longer exists, its slot stays sticky but can be taken by a new workspace
+    void remove(WsId ws_id);
+    // ws_id left the monitor (or another grid claims it), its slot gets synthetic_id
+    void release(WsId ws_id, WsId synthetic_id);
+
+  private:
+    std::unordered_map<WsId, HTGridSlot> ws_slots;
+    // Workspace of every slot, indexed by index()
+    std::vector<WsId> slot_ws;
+    std::set<size_t> free;
+    int layers = 0;
+    int rows = 0;
+    int cols = 0;
+    uint64_t slot_generation = 0;
+
+    bool pinned(WsId ws_id) const { return is_pinned && is_pinned(ws_id); }
+};
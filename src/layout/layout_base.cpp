@@ -1,21 +1,86 @@
+#include <algorithm>
 #include <any>
+#include <array>
+#include <chrono>
+#include <climits>
+#include <ranges>
 #include <sstream>
 
 #define private public
 #include <hyprland/src/config/ConfigManager.hpp>
+#include <hyprland/src/config/ConfigValue.hpp>
 #include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/desktop/view/LayerSurface.hpp>
+#include <hyprland/src/layout/LayoutManager.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
 #include <hyprland/src/render/Renderer.hpp>
+#include <hyprland/src/render/pass/BorderPassElement.hpp>
 #include <hyprland/src/render/pass/ClearPassElement.hpp>
+#include <hyprland/src/render/pass/RectPassElement.hpp>
+#include <hyprland/src/render/pass/TexPassElement.hpp>
 #undef private
 
+#include <hyprutils/utils/ScopeGuard.hpp>
+
+#include "../config.hpp"
 #include "../globals.hpp"
 #include "../pass/pass_element.hpp"
+#include "../render.hpp"
 #include "../types.hpp"
 #include "layout_base.hpp"
 
+using Hyprutils::Utils::CScopeGuard;
+
+// Boxes windows are hit tested against, same as the ones clicks go to
+static const uint64_t HIT_TEST_EXTENTS =
+    Desktop::View::RESERVED_EXTENTS | Desktop::View::INPUT_EXTENTS;
+
+// Call fn on the mapped windows of workspace, topmost first, until it returns true. Same order as
+// vectorToWindowUnified: pinned windows on top, then a fullscreen window with only the floating
+// windows created over it above it, else floating windows above tiled ones. Later windows are
+// above earlier ones.
+template<typename Fn>
+static void for_each_window_top_down(const PHLWORKSPACE& workspace, Fn&& fn) {
+    // Returns true once fn did
+    auto pass = [&workspace, &fn](auto&& include) {
+        for (const PHLWINDOW& window : g_pCompositor->m_windows | std::views::reverse) {
+            if (window == nullptr || !window->m_isMapped || window->isHidden())
+                continue;
+            if (window->m_workspace != workspace || !include(window))
+                continue;
+            if (fn(window))
+                return true;
+        }
+        return false;
+    };
+
+    if (pass([](const PHLWINDOW& window) { return window->m_pinned; }))
+        return;
+
+    const PHLWINDOW fullscreen =
+        workspace->m_hasFullscreenWindow ? workspace->getFullscreenWindow() : nullptr;
+    if (fullscreen != nullptr) {
+        const bool above = pass([&fullscreen](const PHLWINDOW& window) {
+            return window != fullscreen && !window->m_pinned && window->m_isFloating
+                && window->m_createdOverFullscreen;
+        });
+        // Everything else on the workspace is behind the fullscreen window, and not drawn
+        if (!above && !fullscreen->m_pinned)
+            pass([&fullscreen](const PHLWINDOW& window) { return window == fullscreen; });
+        return;
+    }
+
+    for (const bool floating : {true, false}) {
+        const bool found = pass([floating](const PHLWINDOW& window) {
+            return !window->m_pinned && window->m_isFloating == floating;
+        });
+        if (found)
+            return;
+    }
+}
+
 HTLayoutBase::HTLayoutBase(VIEWID new_view_id) : view_id(new_view_id) {
-    ;
+    thumbnails.on_commit = [this](WORKSPACEID ws_id) { on_thumbnail_commit(ws_id); };
 }
 
 void HTLayoutBase::on_move_swipe(Vector2D delta) {
@@ -49,16 +114,58 @@ bool HTLayoutBase::should_manage_mouse() {
     return true;
 }
 
-bool HTLayoutBase::should_render_window(PHLWINDOW window) {
+bool HTLayoutBase::should_render_window(PHLWINDOW window, bool ori_result) {
+    return ori_result;
+}
+
+void HTLayoutBase::update_visible_windows() {
+    visible_windows.clear();
+    frame_dragged_window = nullptr;
+    visible_windows_valid = false;
+
     const PHLMONITOR monitor = get_monitor();
-    if (monitor == nullptr || window == nullptr)
-        return false;
+    if (monitor == nullptr)
+        return;
+
+    const SP<Layout::ITarget> target = g_layoutManager->dragController()->target();
+    if (target != nullptr && target->window() != nullptr)
+        frame_dragged_window = target->window().get();
+
+    const CBox monitor_box = monitor->logicalBox();
+    for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+        if (window == nullptr)
+            continue;
+        const PHLWORKSPACE workspace = window->m_workspace;
+        if (workspace == nullptr || workspace->m_monitor != monitor)
+            continue;
+        CBox window_box = window->getWindowMainSurfaceBox();
+        ws_boxes_to_global({&window_box, 1}, workspace->m_id);
+        if (window_box.empty() || window_box.intersection(monitor_box).empty())
+            continue;
+        visible_windows.push_back(window.get());
+    }
+    std::ranges::sort(visible_windows);
+    visible_windows_valid = true;
+}
+
+bool HTLayoutBase::is_dragged_window(PHLWINDOW window) {
+    if (visible_windows_valid)
+        return window.get() == frame_dragged_window;
+    const SP<Layout::ITarget> target = g_layoutManager->dragController()->target();
+    return target != nullptr && window == target->window();
+}
 
-    return ((should_render_window_t)(should_render_window_hook->m_original))(
-        g_pHyprRenderer.get(),
-        window,
-        monitor
-    );
+bool HTLayoutBase::is_window_visible(PHLWINDOW window) {
+    if (visible_windows_valid)
+        return std::ranges::binary_search(visible_windows, window.get());
+
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr || window->m_workspace == nullptr)
+        return false;
+    const CBox window_box = get_global_window_box(window, window->workspaceID());
+    if (window_box.empty())
+        return false;
+    return !window_box.intersection(monitor->logicalBox()).empty();
 }
 
 float HTLayoutBase::drag_window_scale() {
@@ -74,20 +181,151 @@ void HTLayoutBase::build_overview_layout(HTViewStage stage) {
 }
 
 void HTLayoutBase::render() {
+    pass_start = g_pHyprRenderer->m_renderPass.m_passElements.size();
+
     CClearPassElement::SClearData data;
     data.color = CHyprColor {0};
     g_pHyprRenderer->m_renderPass.add(makeUnique<CClearPassElement>(data));
 }
 
+void HTLayoutBase::render_closed() {
+    ;
+}
+
+void HTLayoutBase::pre_render() {
+    ;
+}
+
+bool HTLayoutBase::on_damage(const CBox& box) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return false;
+
+    // Thumbnails are rendered unscaled, so damage lands in the same place for every workspace.
+    // Only the screen is damaged here, the commits of the surfaces mark thumbnails dirty.
+    bool hit_layer = false;
+    for (size_t i = 0; i < HTLayerHideScope::HIDDEN_LAYERS && !hit_layer; i++) {
+        for (const PHLLSREF& ls_ref : monitor->m_layerSurfaceLayers[i]) {
+            const PHLLS ls = ls_ref.lock();
+            if (ls == nullptr)
+                continue;
+            const CBox ls_box =
+                CBox {ls->m_geometry}.translate(-monitor->m_position).scale(monitor->m_scale);
+            if (ls_box.intersection(box).empty())
+                continue;
+            hit_layer = true;
+            break;
+        }
+    }
+    if (hit_layer) {
+        for (const auto& [id, layout] : overview_layout)
+            damage_ws_region(id, box);
+    }
+
+    bool hit_window = false;
+    for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+        if (window == nullptr || !window->m_isMapped || window->isHidden())
+            continue;
+        const PHLWORKSPACE workspace = window->m_workspace;
+        if (workspace == nullptr || workspace->m_monitor != monitor)
+            continue;
+        const CBox window_box = window->getFullWindowBoundingBox()
+                                    .translate(-monitor->m_position)
+                                    .scale(monitor->m_scale);
+        if (window_box.intersection(box).empty())
+            continue;
+        damage_ws_region(workspace->m_id, box);
+        hit_window = true;
+    }
+
+    // Overlay layer surfaces (the level right above the hidden ones) are in every thumbnail
+    bool hit_overlay = false;
+    const auto& overlays = monitor->m_layerSurfaceLayers[HTLayerHideScope::HIDDEN_LAYERS];
+    for (const PHLLSREF& ls_ref : overlays) {
+        const PHLLS ls = ls_ref.lock();
+        if (ls == nullptr)
+            continue;
+        const CBox ls_box =
+            CBox {ls->m_geometry}.translate(-monitor->m_position).scale(monitor->m_scale);
+        if (ls_box.intersection(box).empty())
+            continue;
+        hit_overlay = true;
+        break;
+    }
+    if (hit_overlay) {
+        for (const auto& [id, layout] : overview_layout)
+            damage_ws_region(id, box);
+    }
+
+    return hit_layer || hit_window || hit_overlay;
+}
+
+bool HTLayoutBase::shown_when_closed() {
+    if (!draws_when_closed)
+        return false;
+    const PHLMONITOR monitor = get_monitor();
+    return monitor == nullptr || monitor->m_activeWorkspace == nullptr
+        || !monitor->m_activeWorkspace->m_hasFullscreenWindow;
+}
+
+void HTLayoutBase::on_thumbnail_commit(WORKSPACEID ws_id) {
+    // Closed layouts only keep the dirty flag, prewarm refreshes on its own schedule
+    const PHTVIEW view = ht_manager->get_view_from_id(view_id);
+    if (view == nullptr || (!view->active && !view->navigating && !shown_when_closed()))
+        return;
+
+    view->wake();
+    for (const auto& [id, ws_layout] : overview_layout) {
+        if (ws_id == WORKSPACE_INVALID || id == ws_id)
+            damage_box(ws_layout.box);
+    }
+}
+
+bool HTLayoutBase::is_animating() {
+    return false;
+}
+
+void HTLayoutBase::damage_box(const CBox& box) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr || box.empty())
+        return;
+
+    const bool was_blocking = ht_manager->block_damage_reporting;
+    ht_manager->block_damage_reporting = true;
+    monitor->addDamage(box);
+    ht_manager->block_damage_reporting = was_blocking;
+}
+
+void HTLayoutBase::damage_ws_region(WORKSPACEID workspace_id, const CBox& box) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+
+    const auto it = overview_layout.find(workspace_id);
+    if (it == overview_layout.end() || it->second.box.empty())
+        return;
+
+    const CBox& ws_box = it->second.box;
+    const double ratio = ws_box.w / monitor->m_transformedSize.x;
+    // Expand by a pixel to cover rounding of the scaled render
+    const CBox cell_box = CBox {ws_box}.expand(1);
+    const CBox mapped = CBox {ws_box.pos() + box.pos() * ratio, box.size() * ratio}.expand(1);
+    damage_box(mapped.intersection(cell_box));
+}
+
 const std::string CLEAR_PASS_ELEMENT_NAME = "CClearPassElement";
 
 void HTLayoutBase::post_render() {
-    bool first = true;
-    std::erase_if(g_pHyprRenderer->m_renderPass.m_passElements, [&first](const auto& e) {
-        bool res = e->element->passName() == CLEAR_PASS_ELEMENT_NAME && !first;
-        first = false;
-        return res;
+    visible_windows_valid = false;
+
+    // Everything before pass_start was there before the overview rendered. Only the very first
+    // element of the pass may stay a clear.
+    auto& elements = g_pHyprRenderer->m_renderPass.m_passElements;
+    const size_t from = std::min(std::max(pass_start, (size_t)1), elements.size());
+    const auto removed = std::remove_if(elements.begin() + from, elements.end(), [](const auto& e) {
+        return e->element->passName() == CLEAR_PASS_ELEMENT_NAME;
     });
+    elements.erase(removed, elements.end());
     g_pHyprRenderer->m_renderPass.add(makeUnique<HTPassElement>());
     // g_pHyprOpenGL->setDamage(CRegion {CBox {0, 0, INT32_MAX, INT32_MAX}});
 }
@@ -107,20 +345,539 @@ WORKSPACEID HTLayoutBase::get_ws_id_from_global(Vector2D pos) {
     if (!monitor->logicalBox().containsPoint(pos))
         return WORKSPACE_INVALID;
 
-    Vector2D relative_pos = (pos - monitor->m_position) * monitor->m_scale;
+    return find_ws_at((pos - monitor->m_position) * monitor->m_scale);
+}
+
+PHLWINDOW HTLayoutBase::get_window_from_global(Vector2D pos) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return nullptr;
+
+    const WORKSPACEID ws_id = get_ws_id_from_global(pos);
+    const PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByID(ws_id);
+    if (workspace == nullptr)
+        return nullptr;
+
+    // Where pos would be if the workspace was shown unscaled on the monitor
+    const Vector2D ws_pos = global_to_local_ws_unscaled(pos, ws_id) + monitor->m_position;
+
+    PHLWINDOW found = nullptr;
+    for_each_window_top_down(workspace, [&found, &ws_pos](const PHLWINDOW& window) {
+        if (!window->getWindowBoxUnified(HIT_TEST_EXTENTS).containsPoint(ws_pos))
+            return false;
+        found = window;
+        return true;
+    });
+    return found;
+}
+
+void HTLayoutBase::queue_thumbnail_refresh(
+    WORKSPACEID ws_id,
+    Vector2D size,
+    HTRenderDetail detail,
+    const CBox& ws_box
+) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+
+    // Tiers keep their order whatever the distance, closer and staler cells go first within one
+    double tier = 3;
+    const HTThumbnail* thumb = thumbnails.find(ws_id);
+    if (monitor->m_activeWorkspace != nullptr && ws_id == monitor->m_activeWorkspace->m_id)
+        tier = 0;
+    else if (ws_id == hovered_ws_id)
+        tier = 1;
+    else if (thumb == nullptr)
+        tier = 2;
+
+    const Vector2D cursor =
+        (g_pInputManager->getMouseCoordsInternal() - monitor->m_position) * monitor->m_scale;
+    const double distance = ws_box.middle().distance(cursor);
+    const double age = thumb == nullptr
+        ? 0.0
+        : std::chrono::duration<double>(Time::steadyNow() - thumb->refreshed_at).count();
+
+    refresh_queue.push_back({ws_id, size, detail, ws_box, tier * 1e9 + distance / (1.0 + age)});
+}
+
+void HTLayoutBase::run_thumbnail_refreshes(
+    PHLMONITOR monitor,
+    const Time::steady_tp& time,
+    bool prewarming
+) {
+    deferred_refreshes.clear();
+    if (refresh_queue.empty())
+        return;
+    CScopeGuard x([this] { refresh_queue.clear(); });
+
+    std::ranges::sort(refresh_queue, {}, &HTRefreshRequest::priority);
+
+    const float BUDGET_MS = HTConfig::snapshot().thumbnail_budget_ms;
+    const auto start = std::chrono::steady_clock::now();
+    auto over_budget = [&start, BUDGET_MS] {
+        const auto spent = std::chrono::steady_clock::now() - start;
+        return BUDGET_MS > 0
+            && std::chrono::duration<double, std::milli>(spent).count() >= BUDGET_MS;
+    };
+
+    uint64_t refreshed = 0;
+    for (const HTRefreshRequest& request : refresh_queue) {
+        // At least one refresh per frame, so a single slow workspace cannot stall the rest
+        if (refreshed > 0 && over_budget()) {
+            deferred_refreshes.insert(request.ws_id);
+            damage_box(request.ws_box);
+            continue;
+        }
+        thumbnails.refresh(monitor, request.ws_id, request.size, time, request.detail);
+        damage_box(request.ws_box);
+        refreshed++;
+    }
+
+    if (prewarming) {
+        stats.prewarm_refreshes += refreshed;
+        stats.prewarm_deferred += deferred_refreshes.size();
+        return;
+    }
+    stats.thumbnail_refreshes += refreshed;
+    stats.deferred_refreshes += deferred_refreshes.size();
+    stats.last_frame_deferred = deferred_refreshes.size();
+}
+
+std::optional<HTLayoutBase::HTThumbnailSpec> HTLayoutBase::prewarm_spec() {
+    return std::nullopt;
+}
+
+void HTLayoutBase::prewarm(PHLMONITOR monitor, const Time::steady_tp& time) {
+    const auto& PREWARM = HTConfig::snapshot().prewarm;
+    if (!PREWARM.enabled || monitor == nullptr || monitor->m_activeWorkspace == nullptr)
+        return;
+
+    const WORKSPACEID active_id = monitor->m_activeWorkspace->m_id;
+    if (recent_ws_ids.empty() || recent_ws_ids.front() != active_id) {
+        std::erase(recent_ws_ids, active_id);
+        recent_ws_ids.insert(recent_ws_ids.begin(), active_id);
+    }
+
+    const Time::steady_dur interval = PREWARM.refresh_rate > 0
+        ? std::chrono::duration_cast<Time::steady_dur>(
+              std::chrono::duration<double>(1.0 / PREWARM.refresh_rate)
+          )
+        : Time::steady_dur::zero();
+    if (!prewarm_requested && time - last_prewarm < interval)
+        return;
+    last_prewarm = time;
+    prewarm_requested = false;
+
+    std::erase_if(recent_ws_ids, [&monitor](WORKSPACEID id) {
+        const PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByID(id);
+        return workspace == nullptr || workspace->m_monitor != monitor
+            || workspace->m_isSpecialWorkspace;
+    });
+    if (recent_ws_ids.size() > (size_t)std::max(PREWARM.workspaces, 0) + 1)
+        recent_ws_ids.resize(PREWARM.workspaces + 1);
+
+    const std::optional<HTThumbnailSpec> spec = prewarm_spec();
+    if (!spec.has_value() || spec->size.x < 1 || spec->size.y < 1)
+        return;
+    if (spec->detail == HT_DETAIL_PLACEHOLDER)
+        return;
+
+    // 4 bytes a pixel, the shared background counts as one more thumbnail
+    const double thumb_mb = spec->size.x * spec->size.y * 4 / (1024.0 * 1024.0);
+    const size_t fits = (size_t)std::max(PREWARM.vram_mb / thumb_mb - 1, 0.0);
+
+    // The active workspace changes under the user's hands, it is rendered when the overview opens
+    std::unordered_set<WORKSPACEID> keep;
+    for (const WORKSPACEID id : recent_ws_ids | std::views::drop(1)) {
+        if (keep.size() >= fits)
+            break;
+        keep.insert(id);
+    }
+    thumbnails.retain(keep);
+    if (fits == 0)
+        return;
+
+    rendering_offscreen = true;
+    CScopeGuard x([this] { rendering_offscreen = false; });
+
+    if (thumbnails.background_needs_refresh(monitor, spec->size))
+        thumbnails.refresh_background(monitor, spec->size, time);
+
+    // Hidden workspaces report no damage, so warm thumbnails go stale with time instead
+    for (const WORKSPACEID id : keep) {
+        const HTThumbnail* thumb = thumbnails.find(id);
+        if (thumb != nullptr && !thumbnails.needs_refresh(id, spec->size, spec->detail)
+            && time - thumb->refreshed_at < interval)
+            continue;
+        queue_thumbnail_refresh(id, spec->size, spec->detail, {});
+    }
+    run_thumbnail_refreshes(monitor, time, true);
+}
+
+void HTLayoutBase::update_hover(Vector2D pos) {
+    // Content damage (video, spinners) leaves the boxes alone, only geometry drops the cache
+    if (hover_check_pending) {
+        hover_check_pending = false;
+        if (hover_cache_valid && HTThumbnailCache::signature(hover_cell_ws_id) != hover_signature)
+            hover_cache_valid = false;
+    }
+    if (!hover_cache_valid || !hover_cell_box.containsPoint(pos))
+        rebuild_hover_cache(pos);
+
+    // Within a cell only the cached boxes are tested, nothing is looked up
+    PHLWINDOW window = nullptr;
+    for (const HTHoverTarget& target : hover_targets) {
+        if (!target.box.containsPoint(pos))
+            continue;
+        window = target.window.lock();
+        break;
+    }
+    set_hover(hover_cell_ws_id, window);
+}
+
+void HTLayoutBase::clear_hover() {
+    hover_cache_valid = false;
+    hover_targets.clear();
+    set_hover(WORKSPACE_INVALID, nullptr);
+}
+
+void HTLayoutBase::rebuild_hover_cache(Vector2D pos) {
+    hover_cache_valid = true;
+    hover_check_pending = false;
+    hover_cell_ws_id = WORKSPACE_INVALID;
+    hover_cell_box = {};
+    hover_targets.clear();
+
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+
+    const WORKSPACEID ws_id = get_ws_id_from_global(pos);
+    const auto it = overview_layout.find(ws_id);
+    if (it == overview_layout.end() || it->second.box.empty())
+        return;
+
+    hover_cell_ws_id = ws_id;
+    hover_signature = HTThumbnailCache::signature(ws_id);
+    const CBox& ws_box = it->second.box;
+    hover_cell_box = {
+        ws_box.pos() / monitor->m_scale + monitor->m_position,
+        ws_box.size() / monitor->m_scale
+    };
+
+    const PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByID(ws_id);
+    if (workspace == nullptr)
+        return;
+    for_each_window_top_down(workspace, [this, ws_id](const PHLWINDOW& window) {
+        CBox box = window->getWindowBoxUnified(HIT_TEST_EXTENTS);
+        ws_boxes_to_global({&box, 1}, ws_id);
+        hover_targets.push_back({window, box});
+        return false;
+    });
+}
+
+void HTLayoutBase::set_hover(WORKSPACEID ws_id, PHLWINDOW window) {
+    const PHLWINDOW old_window = hovered_window.lock();
+    if (ws_id == hovered_ws_id && window == old_window)
+        return;
+
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+
+    // Only the borders change, old ones are damaged before the state moves on
+    if (ws_id != hovered_ws_id) {
+        if (const auto it = overview_layout.find(hovered_ws_id); it != overview_layout.end())
+            damage_border(it->second.box);
+        if (const auto it = overview_layout.find(ws_id); it != overview_layout.end())
+            damage_border(it->second.box);
+    }
+    if (window != old_window) {
+        damage_border(window_cell_box(old_window, hovered_ws_id));
+        damage_border(window_cell_box(window, ws_id));
+    }
+
+    hovered_ws_id = ws_id;
+    hovered_window = window;
+}
+
+void HTLayoutBase::damage_border(const CBox& box) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr || box.empty())
+        return;
+
+    // Borders are drawn outside the box, pad a pixel each way for rounding
+    const double width = HTConfig::snapshot().border_size * monitor->m_scale + 2;
+    const CBox outer = CBox {box}.expand(width - 1);
+    damage_box({outer.x, outer.y, outer.w, width});
+    damage_box({outer.x, outer.y + outer.h - width, outer.w, width});
+    damage_box({outer.x, outer.y, width, outer.h});
+    damage_box({outer.x + outer.w - width, outer.y, width, outer.h});
+}
+
+CBox HTLayoutBase::window_cell_box(PHLWINDOW window, WORKSPACEID ws_id) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr || window == nullptr)
+        return {};
+    CBox box = window->getWindowMainSurfaceBox();
+    ws_boxes_to_global({&box, 1}, ws_id);
+    return box.translate(-monitor->m_position).scale(monitor->m_scale);
+}
+
+bool HTLayoutBase::is_hovered_ws(WORKSPACEID ws_id) const {
+    if (ws_id == WORKSPACE_INVALID || ws_id != hovered_ws_id)
+        return false;
+    return CHyprColor {HTConfig::snapshot().hover_border_color}.a > 0;
+}
+
+void HTLayoutBase::render_hovered_window_border(PHLMONITOR monitor) {
+    const PHLWINDOW window = hovered_window.lock();
+    if (monitor == nullptr || window == nullptr || !is_hovered_ws(hovered_ws_id))
+        return;
+    // The dragged window follows the cursor, not its cell
+    if (is_dragged_window(window))
+        return;
+
+    const CBox box = window_cell_box(window, hovered_ws_id);
+    if (box.empty())
+        return;
+
+    CBorderPassElement::SBorderData data;
+    data.box = box;
+    data.grad1 = HTConfig::snapshot().hover_border_gradient;
+    data.borderSize = HTConfig::snapshot().border_size;
+    g_pHyprRenderer->m_renderPass.add(makeUnique<CBorderPassElement>(data));
+}
+
+void HTLayoutBase::render_cell_border(
+    PHLMONITOR monitor,
+    const CBox& box,
+    const Config::CGradientValueData& grad,
+    float a
+) {
+    if (monitor == nullptr || box.empty() || a <= 0.f)
+        return;
+
+    const float BORDERSIZE = HTConfig::snapshot().border_size;
+    if (!HTConfig::snapshot().flat_borders) {
+        CBorderPassElement::SBorderData data;
+        data.box = box;
+        data.grad1 = grad;
+        data.borderSize = BORDERSIZE;
+        data.a = a;
+        g_pHyprRenderer->m_renderPass.add(makeUnique<CBorderPassElement>(data));
+        return;
+    }
+
+    if (grad.m_colors.empty())
+        return;
+    CHyprColor color = grad.m_colors[0];
+    color.a *= a;
+
+    if (flat_border_batch == nullptr)
+        flat_border_batch = makeUnique<HTFlatBorderElement>();
+    flat_border_batch->add(box, BORDERSIZE * monitor->m_scale, color);
+}
+
+void HTLayoutBase::add_flat_borders() {
+    if (flat_border_batch == nullptr)
+        return;
+    if (!flat_border_batch->empty())
+        g_pHyprRenderer->m_renderPass.add(std::move(flat_border_batch));
+    flat_border_batch.reset();
+}
+
+void HTLayoutBase::begin_texture_batch() {
+    UP<HTTextureBatchElement> batch = makeUnique<HTTextureBatchElement>(texture_pool);
+    texture_batch = batch.get();
+    g_pHyprRenderer->m_renderPass.add(std::move(batch));
+}
+
+void HTLayoutBase::end_texture_batch() {
+    texture_batch = nullptr;
+}
+
+void HTLayoutBase::add_cell_texture(SP<CTexture> tex, const CBox& box) {
+    if (texture_batch != nullptr) {
+        texture_batch->add(std::move(tex), box);
+        return;
+    }
+
+    CTexPassElement::SRenderData tex_data;
+    tex_data.tex = std::move(tex);
+    tex_data.box = box;
+    tex_data.a = 1.f;
+    g_pHyprRenderer->m_renderPass.add(makeUnique<CTexPassElement>(tex_data));
+}
+
+const Config::CGradientValueData& HTLayoutBase::cell_border_gradient(
+    WORKSPACEID ws_id,
+    bool active
+) const {
+    static auto PACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.active_border");
+    static auto PINACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
+
+    if (is_hovered_ws(ws_id))
+        return HTConfig::snapshot().hover_border_gradient;
+    return *(Config::CGradientValueData*)((active ? PACTIVECOL : PINACTIVECOL).ptr());
+}
+
+WORKSPACEID HTLayoutBase::find_ws_at(Vector2D pos) {
     for (const auto& [id, layout] : overview_layout)
-        if (layout.box.containsPoint(relative_pos))
+        if (layout.box.containsPoint(pos))
             return id;
 
     return WORKSPACE_INVALID;
 }
 
 WORKSPACEID HTLayoutBase::get_ws_id_from_xy(int x, int y) {
-    for (const auto& [id, layout] : overview_layout)
-        if (layout.x == x && layout.y == y)
-            return id;
+    x -= xy_index_min_x;
+    y -= xy_index_min_y;
+    if (x < 0 || y < 0 || x >= xy_index_cols || y >= xy_index_rows)
+        return WORKSPACE_INVALID;
+    return xy_index[(size_t)y * xy_index_cols + x];
+}
 
-    return WORKSPACE_INVALID;
+HTLayoutBase::HTLayoutKey HTLayoutBase::base_layout_key(HTViewStage stage) {
+    HTLayoutKey key;
+    key.stage = stage;
+    key.config_generation = ht_manager->config_generation;
+    key.layer = layer;
+
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor != nullptr) {
+        key.monitor_pos = monitor->m_position;
+        key.monitor_size = monitor->m_transformedSize;
+        key.monitor_scale = monitor->m_scale;
+    }
+    return key;
+}
+
+bool HTLayoutBase::restore_cached_layout(const HTLayoutKey& key) {
+    if (current_layout_key == key) {
+        stats.layout_hits++;
+        return true;
+    }
+
+    // On a miss the stage's own storage is rebuilt in place, keeping its capacity
+    make_live(key.stage);
+    if (layout_cache[key.stage].key != key) {
+        stats.layout_misses++;
+        return false;
+    }
+
+    stats.layout_hits++;
+    current_layout_key = key;
+    hover_cache_valid = false;
+    return true;
+}
+
+void HTLayoutBase::store_cached_layout(const HTLayoutKey& key) {
+    layout_cache[key.stage].key = key;
+    current_layout_key = key;
+    hover_cache_valid = false;
+    rebuild_index();
+}
+
+void HTLayoutBase::make_live(HTViewStage stage) {
+    if (live_stage == stage)
+        return;
+    // Put the current stage back first, then take the leftovers in its place
+    if (live_stage.has_value())
+        swap_stage(*live_stage);
+    swap_stage(stage);
+    live_stage = stage;
+}
+
+void HTLayoutBase::swap_stage(HTViewStage stage) {
+    HTCachedLayout& cached = layout_cache[stage];
+    std::swap(overview_layout, cached.layout);
+    std::swap(xy_index, cached.xy_index);
+    std::swap(xy_index_min_x, cached.xy_index_min_x);
+    std::swap(xy_index_min_y, cached.xy_index_min_y);
+    std::swap(xy_index_cols, cached.xy_index_cols);
+    std::swap(xy_index_rows, cached.xy_index_rows);
+    std::swap(ws_transforms, cached.ws_transforms);
+    std::swap(ws_inverse_transforms, cached.ws_inverse_transforms);
+    std::swap(transform_index, cached.transform_index);
+    std::swap(transform_monitor_scale, cached.transform_monitor_scale);
+    std::swap(transform_monitor_pos, cached.transform_monitor_pos);
+}
+
+HTLayoutBase::HTWorkspace HTLayoutBase::ws_layout(WORKSPACEID workspace_id) const {
+    const auto it = overview_layout.find(workspace_id);
+    if (it == overview_layout.end())
+        return HTWorkspace {0, 0, {}};
+    return it->second;
+}
+
+HTViewStage HTLayoutBase::current_layout_stage() const {
+    return current_layout_key.has_value() ? current_layout_key->stage : HT_VIEW_ANIMATING;
+}
+
+void HTLayoutBase::rebuild_index() {
+    xy_index.clear();
+    xy_index_cols = 0;
+    xy_index_rows = 0;
+    if (overview_layout.empty())
+        return;
+
+    int max_x = INT_MIN, max_y = INT_MIN;
+    xy_index_min_x = INT_MAX;
+    xy_index_min_y = INT_MAX;
+    for (const auto& [id, layout] : overview_layout) {
+        xy_index_min_x = std::min(xy_index_min_x, layout.x);
+        xy_index_min_y = std::min(xy_index_min_y, layout.y);
+        max_x = std::max(max_x, layout.x);
+        max_y = std::max(max_y, layout.y);
+    }
+
+    xy_index_cols = max_x - xy_index_min_x + 1;
+    xy_index_rows = max_y - xy_index_min_y + 1;
+    xy_index.assign((size_t)xy_index_cols * xy_index_rows, WORKSPACE_INVALID);
+    for (const auto& [id, layout] : overview_layout) {
+        const size_t i =
+            (size_t)(layout.y - xy_index_min_y) * xy_index_cols + (layout.x - xy_index_min_x);
+        xy_index[i] = id;
+    }
+
+    ws_transforms.clear();
+    ws_inverse_transforms.clear();
+    transform_index.clear();
+
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr || monitor->m_transformedSize.x < 1)
+        return;
+    transform_monitor_scale = monitor->m_scale;
+    transform_monitor_pos = monitor->m_position;
+
+    for (const auto& [id, layout] : overview_layout) {
+        if (layout.box.empty())
+            continue;
+        // Scale the workspace down into its cell, which is in monitor-local pixels
+        const HTWsTransform transform = {
+            layout.box.w / monitor->m_transformedSize.x,
+            layout.box.pos() / monitor->m_scale + monitor->m_position
+        };
+        transform_index[id] = ws_transforms.size();
+        ws_transforms.push_back(transform);
+        ws_inverse_transforms.push_back(transform.inverse());
+    }
+}
+
+const HTWsTransform* HTLayoutBase::ws_transform(WORKSPACEID workspace_id) const {
+    const auto it = transform_index.find(workspace_id);
+    if (it == transform_index.end())
+        return nullptr;
+    return &ws_transforms[it->second];
+}
+
+const HTWsTransform* HTLayoutBase::ws_inverse_transform(WORKSPACEID workspace_id) const {
+    const auto it = transform_index.find(workspace_id);
+    if (it == transform_index.end())
+        return nullptr;
+    return &ws_inverse_transforms[it->second];
 }
 
 CBox HTLayoutBase::get_global_window_box(PHLWINDOW window, WORKSPACEID workspace_id) {
@@ -135,20 +892,16 @@ CBox HTLayoutBase::get_global_window_box(PHLWINDOW window, WORKSPACEID workspace
     if (workspace == nullptr || workspace->m_monitor != monitor)
         return {};
 
-    const CBox ws_window_box = window->getWindowMainSurfaceBox();
-
-    const Vector2D top_left =
-        local_ws_unscaled_to_global(ws_window_box.pos() - monitor->m_position, workspace->m_id);
-    const Vector2D bottom_right = local_ws_unscaled_to_global(
-        ws_window_box.pos() + ws_window_box.size() - monitor->m_position,
-        workspace->m_id
-    );
-
-    return {top_left, bottom_right - top_left};
+    CBox window_box = window->getWindowMainSurfaceBox();
+    ws_boxes_to_global({&window_box, 1}, workspace->m_id);
+    return window_box;
 }
 
 CBox HTLayoutBase::get_global_ws_box(WORKSPACEID workspace_id) {
-    const CBox scaled_ws_box = overview_layout[workspace_id].box;
+    const auto it = overview_layout.find(workspace_id);
+    if (it == overview_layout.end())
+        return {};
+    const CBox& scaled_ws_box = it->second.box;
     const Vector2D top_left = local_ws_scaled_to_global(scaled_ws_box.pos(), workspace_id);
     const Vector2D bottom_right =
         local_ws_scaled_to_global(scaled_ws_box.pos() + scaled_ws_box.size(), workspace_id);
@@ -156,52 +909,64 @@ CBox HTLayoutBase::get_global_ws_box(WORKSPACEID workspace_id) {
 }
 
 Vector2D HTLayoutBase::global_to_local_ws_unscaled(Vector2D pos, WORKSPACEID workspace_id) {
-    const PHLMONITOR monitor = get_monitor();
-    if (monitor == nullptr)
-        return {};
-
-    CBox workspace_box = overview_layout[workspace_id].box;
-    if (workspace_box.empty())
-        return {};
-    pos -= monitor->m_position;
-    pos *= monitor->m_scale;
-    pos -= workspace_box.pos();
-    pos /= monitor->m_scale;
-    pos /= workspace_box.w / monitor->m_transformedSize.x;
+    global_to_local_ws_unscaled({&pos, 1}, workspace_id);
     return pos;
 }
 
 Vector2D HTLayoutBase::global_to_local_ws_scaled(Vector2D pos, WORKSPACEID workspace_id) {
-    const PHLMONITOR monitor = get_monitor();
-    if (monitor == nullptr)
-        return {};
-
-    pos = global_to_local_ws_unscaled(pos, workspace_id);
-    pos *= monitor->m_scale;
-    return pos;
+    return global_to_local_ws_unscaled(pos, workspace_id) * transform_monitor_scale;
 }
 
 Vector2D HTLayoutBase::local_ws_unscaled_to_global(Vector2D pos, WORKSPACEID workspace_id) {
-    const PHLMONITOR monitor = get_monitor();
-    if (monitor == nullptr)
-        return {};
-
-    CBox workspace_box = overview_layout[workspace_id].box;
-    if (workspace_box.empty())
-        return {};
-    pos *= workspace_box.w / monitor->m_transformedSize.x;
-    pos *= monitor->m_scale;
-    pos += workspace_box.pos();
-    pos /= monitor->m_scale;
-    pos += monitor->m_position;
+    local_ws_unscaled_to_global({&pos, 1}, workspace_id);
     return pos;
 }
 
 Vector2D HTLayoutBase::local_ws_scaled_to_global(Vector2D pos, WORKSPACEID workspace_id) {
-    const PHLMONITOR monitor = get_monitor();
-    if (monitor == nullptr)
-        return {};
+    return local_ws_unscaled_to_global(pos / transform_monitor_scale, workspace_id);
+}
+
+// The loops below only multiply and add, so the compiler can vectorize them
 
-    pos /= monitor->m_scale;
-    return local_ws_unscaled_to_global(pos, workspace_id);
+void HTLayoutBase::global_to_local_ws_unscaled(
+    std::span<Vector2D> points,
+    WORKSPACEID workspace_id
+) {
+    const HTWsTransform* inverse = ws_inverse_transform(workspace_id);
+    if (inverse == nullptr) {
+        std::ranges::fill(points, Vector2D {});
+        return;
+    }
+    const HTWsTransform t = *inverse;
+    for (Vector2D& pos : points)
+        pos = t.apply(pos);
+}
+
+void HTLayoutBase::local_ws_unscaled_to_global(
+    std::span<Vector2D> points,
+    WORKSPACEID workspace_id
+) {
+    const HTWsTransform* transform = ws_transform(workspace_id);
+    if (transform == nullptr) {
+        std::ranges::fill(points, Vector2D {});
+        return;
+    }
+    const HTWsTransform t = *transform;
+    for (Vector2D& pos : points)
+        pos = t.apply(pos);
+}
+
+void HTLayoutBase::ws_boxes_to_global(std::span<CBox> boxes, WORKSPACEID workspace_id) {
+    const HTWsTransform* transform = ws_transform(workspace_id);
+    if (transform == nullptr) {
+        std::ranges::fill(boxes, CBox {});
+        return;
+    }
+    // Boxes are relative to the monitor before being scaled into the cell
+    const HTWsTransform t = {
+        transform->scale,
+        transform->offset - transform_monitor_pos * transform->scale
+    };
+    for (CBox& box : boxes)
+        box = t.apply(box);
 }
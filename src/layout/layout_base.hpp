@@ -1,13 +1,33 @@
 #pragma once
 
 #include <hyprland/src/SharedDefs.hpp>
+#include <hyprland/src/config/ConfigManager.hpp>
 #include <hyprland/src/desktop/DesktopTypes.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
 #include <hyprutils/math/Box.hpp>
+#include <array>
+#include <optional>
+#include <span>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "../pass/flat_border_element.hpp"
+#include "../pass/texture_batch_element.hpp"
+#include "../stats.hpp"
+#include "../thumbnail.hpp"
 #include "../types.hpp"
 
+// Uniform scale and translation, maps a point p to p * scale + offset
+struct HTWsTransform {
+    double scale = 1.0;
+    Vector2D offset;
+
+    Vector2D apply(const Vector2D& pos) const { return pos * scale + offset; }
+    CBox apply(const CBox& box) const { return {apply(box.pos()), box.size() * scale}; }
+    HTWsTransform inverse() const { return {1.0 / scale, offset * (-1.0 / scale)}; }
+};
+
 enum HTViewStage {
     HT_VIEW_ANIMATING,
     HT_VIEW_OPENED,
@@ -19,6 +39,139 @@ class HTLayoutBase {
     // Same as monitor_id of the parent view
     VIEWID view_id;
 
+    // Dense (x, y) -> workspace table over overview_layout, see rebuild_index
+    std::vector<WORKSPACEID> xy_index;
+    int xy_index_min_x = 0;
+    int xy_index_min_y = 0;
+    int xy_index_cols = 0;
+    int xy_index_rows = 0;
+
+    // Everything build_overview_layout reads, the layout is only rebuilt when this changes
+    struct HTLayoutKey {
+        HTViewStage stage = HT_VIEW_CLOSED;
+        Vector2D monitor_pos;
+        Vector2D monitor_size;
+        double monitor_scale = 0;
+        uint64_t config_generation = 0;
+        int layer = 0;
+        // Animated values the stage depends on, left at zero for those it ignores
+        std::array<double, 3> animated {};
+        // Changes whenever the layout assigns workspaces to other cells
+        uint64_t content_generation = 0;
+
+        bool operator==(const HTLayoutKey&) const = default;
+    };
+
+    // Fill in the parts of the key shared by all layouts
+    HTLayoutKey base_layout_key(HTViewStage stage);
+    // Make the layout built for key current if it is cached, else return false. On a miss,
+    // overview_layout is the storage of key.stage, to be rebuilt and passed to store_cached_layout.
+    bool restore_cached_layout(const HTLayoutKey& key);
+    // Remember overview_layout, just built for key
+    void store_cached_layout(const HTLayoutKey& key);
+
+    // Called whenever overview_layout is rebuilt, layouts extend it with a point index
+    virtual void rebuild_index();
+    // Exchange overview_layout and its index with the ones kept for stage. Layouts with their own
+    // index swap it too.
+    virtual void swap_stage(HTViewStage stage);
+    // Workspace whose cell contains pos (monitor-local pixels), a linear scan unless overridden
+    virtual WORKSPACEID find_ws_at(Vector2D pos);
+
+    // Local unscaled workspace coordinates to global coordinates for every non-empty cell, and
+    // the inverse, rebuilt with the index. transform_index maps a workspace to its entry.
+    std::vector<HTWsTransform> ws_transforms;
+    std::vector<HTWsTransform> ws_inverse_transforms;
+    std::unordered_map<WORKSPACEID, size_t> transform_index;
+    double transform_monitor_scale = 1.0;
+    Vector2D transform_monitor_pos;
+
+    // nullptr if workspace_id has no cell (or an empty one)
+    const HTWsTransform* ws_transform(WORKSPACEID workspace_id) const;
+    const HTWsTransform* ws_inverse_transform(WORKSPACEID workspace_id) const;
+
+    // Stage of the layout currently in overview_layout
+    HTViewStage current_layout_stage() const;
+
+    // Windows drawn in some cell of the current frame, sorted. Only valid while render() runs,
+    // should_render_window computes visibility per call otherwise.
+    std::vector<const Desktop::View::CWindow*> visible_windows;
+    const Desktop::View::CWindow* frame_dragged_window = nullptr;
+    bool visible_windows_valid = false;
+
+    // Thumbnail refresh wanted this frame, see queue_thumbnail_refresh
+    struct HTRefreshRequest {
+        WORKSPACEID ws_id;
+        Vector2D size;
+        HTRenderDetail detail;
+        // Cell the thumbnail is drawn in, monitor-local pixels
+        CBox ws_box;
+        // Lower goes first
+        double priority;
+    };
+    std::vector<HTRefreshRequest> refresh_queue;
+    // Refreshes that did not fit in the last frame's budget
+    std::unordered_set<WORKSPACEID> deferred_refreshes;
+
+    // Ask for the thumbnail of ws_id to be refreshed this frame. Call from pre_render, then
+    // run_thumbnail_refreshes.
+    void queue_thumbnail_refresh(
+        WORKSPACEID ws_id,
+        Vector2D size,
+        HTRenderDetail detail,
+        const CBox& ws_box
+    );
+    // Refresh the queued thumbnails by priority until thumbnail_budget_ms is spent: the active
+    // workspace (only queued by layouts that do not draw it live, like the minimap), the hovered
+    // cell, missing thumbnails, then closest to the cursor and longest waiting. The rest are
+    // damaged so they are retried next frame. Prewarm passes are counted apart from the frames
+    // that show the layout.
+    void run_thumbnail_refreshes(
+        PHLMONITOR monitor,
+        const Time::steady_tp& time,
+        bool prewarming = false
+    );
+    bool is_refresh_deferred(WORKSPACEID ws_id) const { return deferred_refreshes.contains(ws_id); }
+
+    // Fill visible_windows from the current layout, call in render() once the layout is built
+    void update_visible_windows();
+    bool is_dragged_window(PHLWINDOW window);
+    // Whether the window shows in a cell that intersects the monitor
+    bool is_window_visible(PHLWINDOW window);
+
+    // Whether the cell of ws_id should get the hover border instead of its usual one
+    bool is_hovered_ws(WORKSPACEID ws_id) const;
+    // Add a border around the hovered window where it is drawn in its cell, if there is one
+    void render_hovered_window_border(PHLMONITOR monitor);
+    // Border of the cell of ws_id: the hover, active or inactive gradient. Refers to the config,
+    // the only copy is the one stored in the pass element.
+    const Config::CGradientValueData& cell_border_gradient(WORKSPACEID ws_id, bool active) const;
+    // Add the border around a cell (monitor-local box). With flat_borders it is four solid strips
+    // in the first color of grad, collected for add_flat_borders instead of added right away.
+    void render_cell_border(
+        PHLMONITOR monitor,
+        const CBox& box,
+        const Config::CGradientValueData& grad,
+        float a = 1.f
+    );
+    // Add the flat borders collected since the last call to the pass, as one element
+    void add_flat_borders();
+    UP<HTFlatBorderElement> flat_border_batch;
+    // Add one element to the pass that draws every texture given to add_cell_texture until
+    // end_texture_batch. Cells do not overlap, so their thumbnails can all be drawn at this point.
+    void begin_texture_batch();
+    void end_texture_batch();
+    // Composite tex at box (monitor-local pixels), in the open texture batch if there is one
+    void add_cell_texture(SP<CTexture> tex, const CBox& box);
+    // Reused by the texture batch of every frame
+    SP<HTTextureBatchElement::HTPool> texture_pool = makeShared<HTTextureBatchElement::HTPool>();
+    // Owned by the render pass, only valid while the layout renders
+    HTTextureBatchElement* texture_batch = nullptr;
+
+    // Reused by build_overview_layout to list the workspaces of the monitor, keeps its capacity
+    // across the rebuilds of an animation
+    std::vector<WORKSPACEID> scratch_ws_ids;
+
   public:
     using CallbackFun = Hyprutils::Animation::CBaseAnimatedVariable::CallbackFun;
 
@@ -38,6 +191,10 @@ class HTLayoutBase {
 
     virtual CBox calculate_ws_box(int x, int y, HTViewStage stage) = 0;
     std::unordered_map<WORKSPACEID, HTWorkspace> overview_layout;
+    // Cell of workspace_id in overview_layout, all zero if it has none
+    HTWorkspace ws_layout(WORKSPACEID workspace_id) const;
+
+    HTLayoutStats stats;
 
     // Warp the show/hide animations to perc (from closed to open)
     virtual void close_open_lerp(float perc) = 0;
@@ -58,8 +215,9 @@ class HTLayoutBase {
     // Should return true if when active, hyprtasking should manage the mouse button actions
     // (warping to appropriate position and smoothing the drag window, if it exists)
     virtual bool should_manage_mouse();
-    // Called assuming that at least one overview is active (not nec on this monitor)
-    virtual bool should_render_window(PHLWINDOW window);
+    // Called assuming that at least one overview is active (not nec on this monitor), ori_result
+    // is what Hyprland decided
+    virtual bool should_render_window(PHLWINDOW window, bool ori_result);
     // The scale the drag window should be rendered at (about the mouse cursor)
     virtual float drag_window_scale();
     // Only to be called when closed, init/reset the position in case of config/monitor change
@@ -68,12 +226,54 @@ class HTLayoutBase {
     virtual void build_overview_layout(HTViewStage stage);
     // Render the overview
     virtual void render();
+    // Layouts that stay on screen while the overview is closed set draws_when_closed. They are
+    // rendered with render_closed after the stock workspace, kept fresh by pre_render and fed
+    // damage, which still goes to the screen.
+    bool draws_when_closed = false;
+    // draws_when_closed, unless the active workspace has a fullscreen window. Nothing is drawn
+    // over it then, so Hyprland can still scan it out directly.
+    bool shown_when_closed();
+    virtual void render_closed();
+    // Called before the monitor starts a frame, while offscreen rendering is still allowed
+    virtual void pre_render();
+    // Damage reported on the monitor while the overview is shown, box is monitor-local pixels.
+    // Damages the cells showing what was hit, thumbnails are marked dirty by the commits of their
+    // own surfaces instead (see on_thumbnail_commit). Returns false if the damage hits no window
+    // or layer (a software cursor, ...), it then stays screen damage.
+    virtual bool on_damage(const CBox& box);
+    // True while any of the layout's animated variables moves, the whole overview is redrawn
+    virtual bool is_animating();
+
+    // Offscreen copies of workspaces, reused while their contents are unchanged
+    HTThumbnailCache thumbnails;
+    // A surface drawn in the thumbnail of ws_id (WORKSPACE_INVALID for layers) committed. Damages
+    // the cells showing it while the layout is on screen, so pre_render refreshes them.
+    void on_thumbnail_commit(WORKSPACEID ws_id);
+
+    struct HTThumbnailSpec {
+        Vector2D size;
+        HTRenderDetail detail = HT_DETAIL_FULL;
+    };
+    // Thumbnails the opened overview draws its cells from, nullopt if the layout does not use any
+    virtual std::optional<HTThumbnailSpec> prewarm_spec();
+    // Called on frames of the closed overview. Keeps the thumbnails of the most recently used
+    // workspaces up to date, see prewarm:*
+    void prewarm(PHLMONITOR monitor, const Time::steady_tp& time);
+    // The overview may open soon (a gesture started), the next prewarm does not wait for
+    // prewarm:refresh_rate
+    void request_prewarm() { prewarm_requested = true; }
+    // True while a workspace is rendered into a thumbnail, windows should not be culled
+    bool rendering_offscreen = false;
 
-    // Prevent simplification from happening in the plugin, remove all clear pass objects
+    // Prevent simplification from happening in the plugin, remove all clear pass objects added
+    // since render() started
     void post_render();
 
     PHLMONITOR get_monitor();
     WORKSPACEID get_ws_id_from_global(Vector2D pos);
+    // Topmost window under pos (global) in the cell it falls in. Only reads the cached layout,
+    // nothing is focused or switched.
+    PHLWINDOW get_window_from_global(Vector2D pos);
     WORKSPACEID get_ws_id_from_xy(int x, int y);
     std::pair<int, int> get_current_ws_xy();
     CBox get_global_window_box(PHLWINDOW window, WORKSPACEID workspace_id);
@@ -83,4 +283,84 @@ class HTLayoutBase {
     Vector2D global_to_local_ws_unscaled(Vector2D pos, WORKSPACEID workspace_id);
     Vector2D local_ws_scaled_to_global(Vector2D pos, WORKSPACEID workspace_id);
     Vector2D local_ws_unscaled_to_global(Vector2D pos, WORKSPACEID workspace_id);
+
+    // Batch versions of the above, converting points in place. Points of a workspace without a
+    // cell are set to {}.
+    void global_to_local_ws_unscaled(std::span<Vector2D> points, WORKSPACEID workspace_id);
+    void local_ws_unscaled_to_global(std::span<Vector2D> points, WORKSPACEID workspace_id);
+    // Boxes in global coordinates as laid out on the workspace (e.g. window boxes) to where they
+    // are drawn in its cell, in place
+    void ws_boxes_to_global(std::span<CBox> boxes, WORKSPACEID workspace_id);
+
+    // Damage (monitor-local pixels) without reporting it back to on_damage
+    void damage_box(const CBox& box);
+    // Damage the part of a cell that shows box of its unscaled workspace
+    void damage_ws_region(WORKSPACEID workspace_id, const CBox& box);
+
+    // Workspace and window under the pointer, kept up to date by update_hover
+    WORKSPACEID hovered_ws_id = WORKSPACE_INVALID;
+    PHLWINDOWREF hovered_window;
+    // Track the pointer (global), damaging only the borders of what it leaves and enters.
+    // Hit tests the compositor again only when the pointer leaves the cached cell.
+    void update_hover(Vector2D pos);
+    void clear_hover();
+    // Cells or windows moved, the next update_hover rebuilds its cache
+    void invalidate_hover() { hover_cache_valid = false; }
+    // Client damage, the next update_hover rebuilds its cache only if the windows of the hovered
+    // cell moved, resized or restacked (their HTThumbnailCache::signature changed)
+    void check_hover() { hover_check_pending = true; }
+
+  private:
+    // Size of the render pass when render() started, post_render only looks past it
+    size_t pass_start = 0;
+
+    // Layout and index of a stage while another one is current
+    struct HTCachedLayout {
+        std::optional<HTLayoutKey> key;
+        std::unordered_map<WORKSPACEID, HTWorkspace> layout;
+        std::vector<WORKSPACEID> xy_index;
+        int xy_index_min_x = 0;
+        int xy_index_min_y = 0;
+        int xy_index_cols = 0;
+        int xy_index_rows = 0;
+        std::vector<HTWsTransform> ws_transforms;
+        std::vector<HTWsTransform> ws_inverse_transforms;
+        std::unordered_map<WORKSPACEID, size_t> transform_index;
+        double transform_monitor_scale = 1.0;
+        Vector2D transform_monitor_pos;
+    };
+    // Last layout built for each stage, and the key of the one in overview_layout. The entry of
+    // live_stage holds leftovers, its layout and index are the current members.
+    std::array<HTCachedLayout, 3> layout_cache;
+    std::optional<HTLayoutKey> current_layout_key;
+    std::optional<HTViewStage> live_stage;
+
+    // Make the members hold the layout and index of stage, swapping the current ones back
+    void make_live(HTViewStage stage);
+
+    // Workspaces of the monitor, most recently active first
+    std::vector<WORKSPACEID> recent_ws_ids;
+    Time::steady_tp last_prewarm;
+    bool prewarm_requested = false;
+
+    struct HTHoverTarget {
+        PHLWINDOWREF window;
+        // Input box, global and where it is drawn in the cell
+        CBox box;
+    };
+    // Cell under the pointer (global) and its windows, topmost first
+    WORKSPACEID hover_cell_ws_id = WORKSPACE_INVALID;
+    CBox hover_cell_box;
+    std::vector<HTHoverTarget> hover_targets;
+    bool hover_cache_valid = false;
+    // Signature of the hovered cell's windows when the cache was built, see check_hover
+    size_t hover_signature = 0;
+    bool hover_check_pending = false;
+
+    void rebuild_hover_cache(Vector2D pos);
+    void set_hover(WORKSPACEID ws_id, PHLWINDOW window);
+    // Damage the border drawn around box (monitor-local pixels), not what it encloses
+    void damage_border(const CBox& box);
+    // Where the main surface of window is drawn in the cell of ws_id, monitor-local pixels
+    CBox window_cell_box(PHLWINDOW window, WORKSPACEID ws_id);
 };
@@ -1,17 +1,20 @@
 #include "linear.hpp"
 
+#include <algorithm>
+
 #include <hyprland/src/Compositor.hpp>
 #include <hyprland/src/config/ConfigManager.hpp>
 #include <hyprland/src/config/ConfigValue.hpp>
 #include <hyprland/src/helpers/MiscFunctions.hpp>
 #include <hyprland/src/managers/animation/AnimationManager.hpp>
 #include <hyprland/src/config/shared/animation/AnimationTree.hpp>
-#include <hyprland/src/managers/animation/DesktopAnimationManager.hpp>
 #include <hyprland/src/config/shared/workspace/WorkspaceRuleManager.hpp>
 #include <hyprland/src/layout/LayoutManager.hpp>
 #include <hyprland/src/managers/input/InputManager.hpp>
-#include <hyprland/src/render/pass/BorderPassElement.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
+#include <hyprland/src/render/Renderer.hpp>
 #include <hyprland/src/render/pass/RectPassElement.hpp>
+#include <hyprland/src/render/pass/TexPassElement.hpp>
 #include <hyprutils/math/Box.hpp>
 #include <hyprutils/utils/ScopeGuard.hpp>
 #include <ranges>
@@ -61,7 +64,7 @@ void HTLayoutLinear::close_open_lerp(float perc) {
     const PHLMONITOR monitor = get_monitor();
     if (monitor == nullptr)
         return;
-    const float HEIGHT = HTConfig::value<Config::FLOAT>("linear:height") * monitor->m_scale;
+    const float HEIGHT = HTConfig::snapshot().linear.height * monitor->m_scale;
 
     view_offset->resetAllCallbacks();
     blur_strength->resetAllCallbacks();
@@ -81,16 +84,26 @@ void HTLayoutLinear::on_show(CallbackFun on_complete) {
     if (monitor == nullptr)
         return;
 
-    const float HEIGHT = HTConfig::value<Config::FLOAT>("linear:height") * monitor->m_scale;
+    const float HEIGHT = HTConfig::snapshot().linear.height * monitor->m_scale;
     *view_offset = HEIGHT;
     *blur_strength = 2.0;
     *dim_opacity = 0.4;
+
+    // Captured in pre_render, outside of the monitor render pass
+    frozen_pending = HTConfig::snapshot().linear.frozen_background;
+    if (!frozen_pending)
+        release_frozen_background();
 }
 
 void HTLayoutLinear::on_hide(CallbackFun on_complete) {
     CScopeGuard x([this, &on_complete] {
-        if (on_complete != nullptr)
-            view_offset->setCallbackOnEnd(on_complete);
+        // The frozen background is still shown while closing, free it once closed
+        view_offset->setCallbackOnEnd([this, on_complete](auto var) {
+            frozen_pending = false;
+            release_frozen_background();
+            if (on_complete != nullptr)
+                on_complete(var);
+        });
     });
 
     const PHLMONITOR monitor = get_monitor();
@@ -112,7 +125,7 @@ void HTLayoutLinear::on_move(WORKSPACEID old_id, WORKSPACEID new_id, CallbackFun
     if (monitor == nullptr)
         return;
 
-    const float GAP_SIZE = HTConfig::value<Config::FLOAT>("gap_size") * monitor->m_scale;
+    const float GAP_SIZE = HTConfig::snapshot().gap_size * monitor->m_scale;
 
     const PHLWORKSPACE new_ws = g_pCompositor->getWorkspaceByID(new_id);
     if (new_ws == nullptr)
@@ -120,9 +133,9 @@ void HTLayoutLinear::on_move(WORKSPACEID old_id, WORKSPACEID new_id, CallbackFun
 
     build_overview_layout(HT_VIEW_ANIMATING);
 
-    const float cur_screen_min_x = overview_layout[new_id].box.x - GAP_SIZE;
-    const float cur_screen_max_x =
-        overview_layout[new_id].box.x + overview_layout[new_id].box.w + GAP_SIZE;
+    const CBox new_box = ws_layout(new_id).box;
+    const float cur_screen_min_x = new_box.x - GAP_SIZE;
+    const float cur_screen_max_x = new_box.x + new_box.w + GAP_SIZE;
 
     if (cur_screen_min_x < 0) {
         *scroll_offset = scroll_offset->value() - cur_screen_min_x;
@@ -139,7 +152,7 @@ bool HTLayoutLinear::on_mouse_axis(double delta) {
     if (monitor == nullptr)
         return false;
 
-    const float GAP_SIZE = HTConfig::value<Config::FLOAT>("gap_size") * monitor->m_scale;
+    const float GAP_SIZE = HTConfig::snapshot().gap_size * monitor->m_scale;
 
     const float total_ws_width =
         (overview_layout.size() * (GAP_SIZE + calculate_ws_box(0, 0, HT_VIEW_ANIMATING).w))
@@ -152,7 +165,7 @@ bool HTLayoutLinear::on_mouse_axis(double delta) {
     }
 
     double new_offset = scroll_offset->goal()
-        + delta * HTConfig::value<Config::FLOAT>("linear:scroll_speed") * -10.f;
+        + delta * HTConfig::snapshot().linear.scroll_speed * -10.f;
 
     const float max_x = new_offset
         + (overview_layout.size() * (GAP_SIZE + calculate_ws_box(0, 0, HT_VIEW_ANIMATING).w))
@@ -171,7 +184,7 @@ bool HTLayoutLinear::on_mouse_axis(double delta) {
 }
 
 const float calculate_y(float size_y, float offset_value, float max_offset) {
-    const bool top = HTConfig::value<Config::FLOAT>("linear:top");
+    const bool top = HTConfig::snapshot().linear.top;
     if (top)
         return offset_value - max_offset;
     return size_y - offset_value;
@@ -182,7 +195,7 @@ bool HTLayoutLinear::should_manage_mouse() {
     if (monitor == nullptr)
         return 1;
 
-    const float HEIGHT = HTConfig::value<Config::FLOAT>("linear:height") * monitor->m_scale;
+    const float HEIGHT = HTConfig::snapshot().linear.height * monitor->m_scale;
 
     const Vector2D mouse_coords = g_pInputManager->getMouseCoordsInternal();
     CBox scaled_view_box = {
@@ -195,31 +208,170 @@ bool HTLayoutLinear::should_manage_mouse() {
         .containsPoint(mouse_coords);
 }
 
-bool HTLayoutLinear::should_render_window(PHLWINDOW window) {
-    bool ori_result = HTLayoutBase::should_render_window(window);
-
-    const PHLMONITOR monitor = get_monitor();
-    if (window == nullptr || monitor == nullptr)
+bool HTLayoutLinear::should_render_window(PHLWINDOW window, bool ori_result) {
+    if (window == nullptr)
         return ori_result;
 
-    const SP<Layout::ITarget> target = g_layoutManager->dragController()->target();
-    if (target != nullptr && window == target->window())
+    if (is_dragged_window(window))
         return false;
 
     if (rendering_standard_ws)
         return ori_result;
 
-    PHLWORKSPACE workspace = window->m_workspace;
-    if (workspace == nullptr)
-        return false;
+    return ori_result && is_window_visible(window);
+}
 
-    CBox window_box = get_global_window_box(window, window->workspaceID());
-    if (window_box.empty())
+bool HTLayoutLinear::frozen_ready(PHLMONITOR monitor) {
+    if (!HTConfig::snapshot().linear.frozen_background)
+        return false;
+    if (monitor == nullptr || monitor->m_activeWorkspace == nullptr)
         return false;
-    if (window_box.intersection(monitor->logicalBox()).empty())
+    // Moving to another workspace in the overview changes what is behind the strip
+    if (monitor->m_activeWorkspace->m_id != frozen_ws_id)
         return false;
+    if (!frozen_levels[0].isAllocated()
+        || frozen_levels[0].m_size != monitor->m_transformedSize.round())
+        return false;
+    // Blur was turned on after the capture, which then only has the unblurred level
+    return !HTConfig::snapshot().linear.blur || frozen_levels[FROZEN_LEVELS - 1].isAllocated();
+}
+
+void HTLayoutLinear::capture_frozen_background(PHLMONITOR monitor, const Time::steady_tp& time) {
+    const PHLWORKSPACE big_ws = monitor->m_activeWorkspace;
+    const Vector2D size = monitor->m_transformedSize.round();
+    if (big_ws == nullptr || size.x < 1 || size.y < 1)
+        return;
 
-    return ori_result;
+    const bool BLUR = HTConfig::snapshot().linear.blur;
+
+    g_pHyprRenderer->makeEGLCurrent();
+    // Without blur only the unblurred capture is ever drawn, the other levels are not kept
+    for (size_t i = 0; i < FROZEN_LEVELS; i++) {
+        CFramebuffer& fb = frozen_levels[i];
+        if (i > 0 && !BLUR) {
+            fb.release();
+            continue;
+        }
+        if (fb.isAllocated() && fb.m_size == size)
+            continue;
+        fb.release();
+        fb.alloc(size.x, size.y, monitor->m_output->state->state().drmFormat);
+    }
+
+    const bool was_blocking = ht_manager->block_damage_reporting;
+    ht_manager->block_damage_reporting = true;
+    rendering_standard_ws = true;
+    CScopeGuard x([this, was_blocking] {
+        ht_manager->block_damage_reporting = was_blocking;
+        rendering_standard_ws = false;
+    });
+
+    CRegion fake_damage {0, 0, INT16_MAX, INT16_MAX};
+    const CBox mon_box = {{0, 0}, monitor->m_transformedSize};
+
+    g_pHyprRenderer
+        ->beginRender(monitor, fake_damage, RENDER_MODE_FULL_FAKE, nullptr, &frozen_levels[0]);
+    g_pHyprOpenGL->clear(CHyprColor {0, 0, 0, 0});
+    render_workspace_at_box(monitor, big_ws, time, {{0, 0}, monitor->m_pixelSize});
+    g_pHyprRenderer->endRender();
+
+    // Each level blurs the unblurred capture, they are only cross-faded afterwards
+    for (size_t i = 1; BLUR && i < FROZEN_LEVELS; i++) {
+        g_pHyprRenderer
+            ->beginRender(monitor, fake_damage, RENDER_MODE_FULL_FAKE, nullptr, &frozen_levels[i]);
+        g_pHyprOpenGL->clear(CHyprColor {0, 0, 0, 0});
+        monitor->m_blurFBShouldRender = true;
+
+        CTexPassElement::SRenderData tex_data;
+        tex_data.tex = frozen_levels[0].getTexture();
+        tex_data.box = mon_box;
+        tex_data.a = 1.f;
+        g_pHyprRenderer->m_renderPass.add(makeUnique<CTexPassElement>(tex_data));
+
+        CRectPassElement::SRectData blur_data;
+        blur_data.color = CHyprColor(0, 0, 0, 0);
+        blur_data.box = mon_box;
+        blur_data.blur = true;
+        blur_data.blurA = 2.f * i / (FROZEN_LEVELS - 1);
+        g_pHyprRenderer->m_renderPass.add(makeUnique<CRectPassElement>(blur_data));
+
+        g_pHyprRenderer->endRender();
+    }
+
+    frozen_ws_id = big_ws->m_id;
+    frozen_pending = false;
+}
+
+void HTLayoutLinear::release_frozen_background() {
+    frozen_ws_id = WORKSPACE_INVALID;
+    if (!frozen_levels[0].isAllocated())
+        return;
+    if (g_pHyprRenderer != nullptr)
+        g_pHyprRenderer->makeEGLCurrent();
+    for (CFramebuffer& fb : frozen_levels)
+        fb.release();
+}
+
+void HTLayoutLinear::render_frozen_background(PHLMONITOR monitor) {
+    const CBox mon_box = {{0, 0}, monitor->m_transformedSize};
+
+    auto add_level = [&mon_box](CFramebuffer& fb, float alpha) {
+        CTexPassElement::SRenderData tex_data;
+        tex_data.tex = fb.getTexture();
+        tex_data.box = mon_box;
+        tex_data.a = alpha;
+        g_pHyprRenderer->m_renderPass.add(makeUnique<CTexPassElement>(tex_data));
+    };
+
+    if (!HTConfig::snapshot().linear.blur) {
+        add_level(frozen_levels[0], 1.f);
+        return;
+    }
+
+    // Cross-fade between the two levels around the current blur strength
+    const float pos = std::clamp(blur_strength->value() / 2.f, 0.f, 1.f) * (FROZEN_LEVELS - 1);
+    const size_t lower = std::min((size_t)pos, FROZEN_LEVELS - 1);
+    const size_t upper = std::min(lower + 1, FROZEN_LEVELS - 1);
+    add_level(frozen_levels[lower], 1.f);
+    if (upper != lower && pos - lower > 0.001f)
+        add_level(frozen_levels[upper], pos - lower);
+}
+
+void HTLayoutLinear::pre_render() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+    if (!HTConfig::snapshot().linear.frozen_background)
+        return;
+    if (!frozen_pending && frozen_ready(monitor))
+        return;
+    // Stale capture (the active workspace changed), or a new show
+    if (frozen_pending || frozen_levels[0].isAllocated())
+        capture_frozen_background(monitor, Time::steadyNow());
+}
+
+bool HTLayoutLinear::on_damage(const CBox& box) {
+    if (!HTLayoutBase::on_damage(box))
+        return false;
+
+    // Only the strip is live while the background is frozen
+    if (frozen_ready(get_monitor()))
+        return true;
+
+    // The active workspace is also drawn full size behind the strip, and blur spreads damage
+    if (HTConfig::snapshot().linear.blur) {
+        const PHLMONITOR monitor = get_monitor();
+        if (monitor != nullptr)
+            damage_box({{0, 0}, monitor->m_pixelSize});
+    } else {
+        damage_box(box);
+    }
+    return true;
+}
+
+bool HTLayoutLinear::is_animating() {
+    return scroll_offset->isBeingAnimated() || view_offset->isBeingAnimated()
+        || blur_strength->isBeingAnimated() || dim_opacity->isBeingAnimated();
 }
 
 float HTLayoutLinear::drag_window_scale() {
@@ -249,8 +401,8 @@ CBox HTLayoutLinear::calculate_ws_box(int x, int y, HTViewStage stage) {
     if (monitor->m_transformedSize.x < 1 || monitor->m_transformedSize.y < 1)
         return {};
 
-    const float HEIGHT = HTConfig::value<Config::FLOAT>("linear:height") * monitor->m_scale;
-    const float GAP_SIZE = HTConfig::value<Config::FLOAT>("gap_size") * monitor->m_scale;
+    const float HEIGHT = HTConfig::snapshot().linear.height * monitor->m_scale;
+    const float GAP_SIZE = HTConfig::snapshot().gap_size * monitor->m_scale;
 
     if (HEIGHT < 0 || HEIGHT > monitor->m_transformedSize.y)
         return {};
@@ -277,9 +429,18 @@ void HTLayoutLinear::build_overview_layout(HTViewStage stage) {
     if (monitor == nullptr)
         return;
 
+    HTLayoutKey key = base_layout_key(stage);
+    key.content_generation = ht_manager->workspace_generation;
+    key.animated[0] = scroll_offset->value();
+    if (stage == HT_VIEW_ANIMATING)
+        key.animated[1] = view_offset->value();
+    if (restore_cached_layout(key))
+        return;
+
     overview_layout.clear();
 
-    std::vector<WORKSPACEID> monitor_workspaces;
+    std::vector<WORKSPACEID>& monitor_workspaces = scratch_ws_ids;
+    monitor_workspaces.clear();
     for (PHLWORKSPACE workspace : g_pCompositor->getWorkspacesCopy()) {
         if (workspace == nullptr)
             continue;
@@ -300,6 +461,41 @@ void HTLayoutLinear::build_overview_layout(HTViewStage stage) {
         CBox ws_box = calculate_ws_box(x, 0, stage);
         overview_layout[ws_id] = {x, 0, ws_box};
     }
+
+    store_cached_layout(key);
+}
+
+void HTLayoutLinear::rebuild_index() {
+    HTLayoutBase::rebuild_index();
+
+    index_intervals.clear();
+    index_intervals.reserve(overview_layout.size());
+    for (const auto& [ws_id, ws_layout] : overview_layout)
+        index_intervals.emplace_back(ws_layout.box.x, ws_id);
+    std::sort(index_intervals.begin(), index_intervals.end());
+}
+
+void HTLayoutLinear::swap_stage(HTViewStage stage) {
+    HTLayoutBase::swap_stage(stage);
+    std::swap(index_intervals, stage_index_intervals[stage]);
+}
+
+WORKSPACEID HTLayoutLinear::find_ws_at(Vector2D pos) {
+    // Last cell starting at or before pos, the only one that can contain it
+    auto it = std::upper_bound(
+        index_intervals.begin(),
+        index_intervals.end(),
+        pos.x,
+        [](double x, const auto& interval) { return x < interval.first; }
+    );
+    if (it == index_intervals.begin())
+        return WORKSPACE_INVALID;
+    --it;
+
+    const auto layout_it = overview_layout.find(it->second);
+    if (layout_it == overview_layout.end() || !layout_it->second.box.containsPoint(pos))
+        return WORKSPACE_INVALID;
+    return it->second;
 }
 
 void HTLayoutLinear::render() {
@@ -313,70 +509,39 @@ void HTLayoutLinear::render() {
     if (monitor == nullptr)
         return;
 
-    static auto PACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.active_border");
-    static auto PINACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
-
-    auto* const ACTIVECOL = (Config::CGradientValueData*)(PACTIVECOL.ptr());
-    auto* const INACTIVECOL = (Config::CGradientValueData*)(PINACTIVECOL.ptr());
-
-    const float BORDERSIZE = HTConfig::value<Config::FLOAT>("border_size");
-    const float HEIGHT = HTConfig::value<Config::FLOAT>("linear:height") * monitor->m_scale;
+    const float HEIGHT = HTConfig::snapshot().linear.height * monitor->m_scale;
 
     const auto time = Time::steadyNow();
 
 
-    g_pHyprRenderer->damageMonitor(monitor);
     g_pHyprRenderer->m_renderData.pMonitor->m_blurFBShouldRender = true;
 
-    // Do a dance with active workspaces: Hyprland will only properly render the
-    // current active one so make the workspace active before rendering it, etc
-    const PHLWORKSPACE start_workspace = monitor->m_activeWorkspace;
-    g_pDesktopAnimationManager->startAnimation(
-        start_workspace,
-        CDesktopAnimationManager::ANIMATION_TYPE_OUT,
-        false,
-        true
-    );
-    start_workspace->m_visible = false;
+    build_overview_layout(HT_VIEW_ANIMATING);
+    update_visible_windows();
 
+    // Hyprland will only properly render the current active workspace, so the others are rendered
+    // through a HTWorkspaceRenderScope, see render_workspace_at_box
     const PHLWORKSPACE big_ws = monitor->m_activeWorkspace;
 
     rendering_standard_ws = true;
-    monitor->m_activeWorkspace = big_ws;
-    g_pDesktopAnimationManager->startAnimation(
-        start_workspace,
-        CDesktopAnimationManager::ANIMATION_TYPE_IN,
-        false,
-        true
-    );
-    big_ws->m_visible = true;
 
     // use pixel size for geometry
     CBox mon_box = {{0, 0}, monitor->m_pixelSize};
-    // Render the current workspace on the screen
-    ((render_workspace_t)(render_workspace_hook->m_original))(
-        g_pHyprRenderer.get(),
-        monitor,
-        big_ws,
-        time,
-        mon_box
-    );
-
-    // add blur/dim over the original workspace
+    const bool frozen = frozen_ready(monitor);
+    // Render the current workspace on the screen, or its snapshot taken on show
+    if (frozen)
+        render_frozen_background(monitor);
+    else
+        render_workspace_at_box(monitor, big_ws, time, mon_box);
+
+    // add blur/dim over the original workspace, the frozen levels are already blurred
     CRectPassElement::SRectData blur_data;
     blur_data.color = CHyprColor(0, 0, 0, dim_opacity->value());
     blur_data.box = mon_box;
-    blur_data.blur = (bool)HTConfig::value<Config::INTEGER>("linear:blur");
+    blur_data.blur = !frozen && (bool)HTConfig::snapshot().linear.blur;
     blur_data.blurA = blur_strength->value();
     g_pHyprRenderer->m_renderPass.add(makeUnique<CRectPassElement>(blur_data));
 
-    g_pDesktopAnimationManager->startAnimation(
-        start_workspace,
-        CDesktopAnimationManager::ANIMATION_TYPE_OUT,
-        false,
-        true
-    );
-    big_ws->m_visible = false;
     rendering_standard_ws = false;
 
     CBox view_box = {
@@ -385,12 +550,10 @@ void HTLayoutLinear::render() {
     };
 
     CRectPassElement::SRectData data;
-    data.color = CHyprColor {HTConfig::value<Config::INTEGER>("bg_color")}.stripA();
+    data.color = CHyprColor {HTConfig::snapshot().bg_color}.stripA();
     data.box = view_box;
     g_pHyprRenderer->m_renderPass.add(makeUnique<CRectPassElement>(data));
 
-    build_overview_layout(HT_VIEW_ANIMATING);
-
     CBox global_mon_box = {monitor->m_position, monitor->m_transformedSize};
     for (const auto& [ws_id, ws_layout] : overview_layout) {
         // Could be nullptr, in which we render only layers
@@ -409,60 +572,16 @@ void HTLayoutLinear::render() {
         if (global_box.intersection(global_mon_box).empty())
             continue;
 
-        const Config::CGradientValueData border_col = workspace == big_ws ? *ACTIVECOL : *INACTIVECOL;
-        CBox border_box = ws_layout.box;
-
-        CBorderPassElement::SBorderData data;
-        data.box = border_box;
-        data.grad1 = border_col;
-        data.borderSize = BORDERSIZE;
-        g_pHyprRenderer->m_renderPass.add(makeUnique<CBorderPassElement>(data));
-
-        if (workspace != nullptr) {
-            monitor->m_activeWorkspace = workspace;
-            g_pDesktopAnimationManager->startAnimation(
-                workspace,
-                CDesktopAnimationManager::ANIMATION_TYPE_IN,
-                false,
-                true
-            );
-            workspace->m_visible = true;
-
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                workspace,
-                time,
-                render_box
-            );
-
-            g_pDesktopAnimationManager->startAnimation(
-                workspace,
-                CDesktopAnimationManager::ANIMATION_TYPE_OUT,
-                false,
-                true
-            );
-            workspace->m_visible = false;
-        } else {
-            // If pWorkspace is null, then just render the layers
-            ((render_workspace_t)(render_workspace_hook->m_original))(
-                g_pHyprRenderer.get(),
-                monitor,
-                workspace,
-                time,
-                render_box
-            );
-        }
+        render_cell_border(
+            monitor,
+            ws_layout.box,
+            cell_border_gradient(ws_id, workspace == big_ws)
+        );
+        render_workspace_at_box(monitor, workspace, time, render_box);
     }
+    add_flat_borders();
 
-    monitor->m_activeWorkspace = start_workspace;
-    g_pDesktopAnimationManager->startAnimation(
-        start_workspace,
-        CDesktopAnimationManager::ANIMATION_TYPE_IN,
-        false,
-        true
-    );
-    start_workspace->m_visible = true;
+    render_hovered_window_border(monitor);
 
     // Render dragged window at mouse cursor
     const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
@@ -482,5 +601,5 @@ void HTLayoutLinear::render() {
                                 .scale(cursor_view->layout->drag_window_scale())
                                 .translate(mouse_coords);
     if (!window_box.intersection(monitor->logicalBox()).empty())
-        render_window_at_box(dragged_window, monitor, time, window_box);
+        render_drag_window_at_box(dragged_window, monitor, time, window_box);
 }
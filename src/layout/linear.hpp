@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+#include <vector>
+
+#include <hyprland/src/render/Framebuffer.hpp>
+
 #include "../types.hpp"
 #include "layout_base.hpp"
 
@@ -12,6 +17,30 @@ class HTLayoutLinear: public HTLayoutBase {
 
     bool rendering_standard_ws;
 
+    // Left edge of every cell and its workspace, sorted by edge
+    std::vector<std::pair<double, WORKSPACEID>> index_intervals;
+    // index_intervals of the other stages, see swap_stage
+    std::array<std::vector<std::pair<double, WORKSPACEID>>, 3> stage_index_intervals;
+
+    // Blur strengths the frozen background is prepared at, evenly spaced up to the open strength
+    static constexpr size_t FROZEN_LEVELS = 3;
+    // The active workspace captured once on show, then blurred at each level, see
+    // linear:frozen_background. Level 0 is the unblurred capture, the others are only allocated
+    // with linear:blur.
+    std::array<CFramebuffer, FROZEN_LEVELS> frozen_levels;
+    WORKSPACEID frozen_ws_id = WORKSPACE_INVALID;
+    bool frozen_pending = false;
+
+    bool frozen_ready(PHLMONITOR monitor);
+    void capture_frozen_background(PHLMONITOR monitor, const Time::steady_tp& time);
+    void release_frozen_background();
+    void render_frozen_background(PHLMONITOR monitor);
+
+  protected:
+    virtual void rebuild_index();
+    virtual void swap_stage(HTViewStage stage);
+    virtual WORKSPACEID find_ws_at(Vector2D pos);
+
   public:
     HTLayoutLinear(VIEWID view_id);
     virtual ~HTLayoutLinear() = default;
@@ -28,7 +57,10 @@ class HTLayoutLinear: public HTLayoutBase {
     virtual bool on_mouse_axis(double delta);
 
     virtual bool should_manage_mouse();
-    virtual bool should_render_window(PHLWINDOW window);
+    virtual bool should_render_window(PHLWINDOW window, bool ori_result);
+    virtual void pre_render();
+    virtual bool on_damage(const CBox& box);
+    virtual bool is_animating();
     virtual float drag_window_scale();
     virtual void init_position();
     virtual void build_overview_layout(HTViewStage stage);
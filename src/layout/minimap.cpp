@@ -0,0 +1,403 @@
+#include "minimap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <ranges>
+
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/config/ConfigManager.hpp>
+#include <hyprland/src/config/ConfigValue.hpp>
+#include <hyprland/src/config/shared/animation/AnimationTree.hpp>
+#include <hyprland/src/layout/LayoutManager.hpp>
+#include <hyprland/src/managers/animation/AnimationManager.hpp>
+#include <hyprland/src/managers/eventLoop/EventLoopManager.hpp>
+#include <hyprland/src/managers/input/InputManager.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
+#include <hyprland/src/render/Renderer.hpp>
+#include <hyprland/src/render/pass/RectPassElement.hpp>
+#include <hyprland/src/render/pass/TexPassElement.hpp>
+#include <hyprutils/math/Box.hpp>
+#include <hyprutils/utils/ScopeGuard.hpp>
+
+#include "../config.hpp"
+#include "../globals.hpp"
+#include "../render.hpp"
+#include "layout_base.hpp"
+
+using Hyprutils::Utils::CScopeGuard;
+
+HTLayoutMinimap::HTLayoutMinimap(VIEWID new_view_id) : HTLayoutBase(new_view_id) {
+    auto &anim_tree = Config::animationTree();
+    g_pAnimationManager->createAnimation(
+        0.f,
+        open_perc,
+        anim_tree->getAnimationPropertyConfig("windowsMove"),
+        AVARDAMAGE_NONE
+    );
+
+    draws_when_closed = true;
+    init_position();
+}
+
+HTLayoutMinimap::~HTLayoutMinimap() {
+    if (refresh_timer != nullptr && g_pEventLoopManager != nullptr)
+        g_pEventLoopManager->removeTimer(refresh_timer);
+}
+
+std::string HTLayoutMinimap::layout_name() {
+    return "minimap";
+}
+
+void HTLayoutMinimap::close_open_lerp(float perc) {
+    open_perc->resetAllCallbacks();
+    open_perc->setValueAndWarp(perc);
+}
+
+void HTLayoutMinimap::on_show(CallbackFun on_complete) {
+    CScopeGuard x([this, &on_complete] {
+        if (on_complete != nullptr)
+            open_perc->setCallbackOnEnd(on_complete);
+    });
+
+    *open_perc = 1.f;
+}
+
+void HTLayoutMinimap::on_hide(CallbackFun on_complete) {
+    CScopeGuard x([this, &on_complete] {
+        if (on_complete != nullptr)
+            open_perc->setCallbackOnEnd(on_complete);
+    });
+
+    // The panel stays, and so does its refresh timer
+    *open_perc = 0.f;
+}
+
+void HTLayoutMinimap::on_move(WORKSPACEID old_id, WORKSPACEID new_id, CallbackFun on_complete) {
+    // The active workspace is drawn live behind the panel, there is nothing to animate
+    if (on_complete != nullptr)
+        open_perc->setCallbackOnEnd(on_complete);
+}
+
+bool HTLayoutMinimap::should_manage_mouse() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return true;
+
+    const Vector2D mouse_coords = g_pInputManager->getMouseCoordsInternal();
+    return calculate_panel_box()
+        .scale(1 / monitor->m_scale)
+        .translate(monitor->m_position)
+        .containsPoint(mouse_coords);
+}
+
+bool HTLayoutMinimap::should_render_window(PHLWINDOW window, bool ori_result) {
+    if (window == nullptr)
+        return ori_result;
+
+    if (is_dragged_window(window))
+        return false;
+
+    // Only the active workspace is rendered live, cells are thumbnails
+    return ori_result;
+}
+
+void HTLayoutMinimap::schedule_refresh(Time::steady_dur delay) {
+    if (refresh_timer == nullptr) {
+        refresh_timer = makeShared<CEventLoopTimer>(
+            std::nullopt,
+            [this](SP<CEventLoopTimer> self, void* data) {
+                // A frame on the panel lets pre_render pick up the thumbnails that are due
+                damage_box(calculate_panel_box());
+            },
+            nullptr
+        );
+        g_pEventLoopManager->addTimer(refresh_timer);
+    }
+    refresh_timer->updateTimeout(delay);
+}
+
+void HTLayoutMinimap::pre_render() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr || monitor->m_activeWorkspace == nullptr)
+        return;
+
+    build_overview_layout(HT_VIEW_ANIMATING);
+
+    const Vector2D size = cell_size().round();
+    if (size.x < 1 || size.y < 1)
+        return;
+
+    const float RATE = HTConfig::snapshot().minimap.refresh_rate;
+    const Time::steady_dur interval = RATE > 0
+        ? std::chrono::duration_cast<Time::steady_dur>(std::chrono::duration<double>(1.0 / RATE))
+        : Time::steady_dur::zero();
+
+    const auto now = Time::steadyNow();
+    std::optional<Time::steady_dur> next_due;
+    // Whether a thumbnail last refreshed at last may refresh again, else remember when it can
+    auto is_due = [&](const Time::steady_tp& last) {
+        const Time::steady_dur wait = last + interval - now;
+        if (wait <= Time::steady_dur::zero())
+            return true;
+        next_due = next_due.has_value() ? std::min(*next_due, wait) : wait;
+        return false;
+    };
+
+    rendering_offscreen = true;
+    CScopeGuard x([this] { rendering_offscreen = false; });
+
+    if (thumbnails.background_needs_refresh(monitor, size)
+        && (thumbnails.find_background() == nullptr || is_due(background_refreshed_at))) {
+        thumbnails.refresh_background(monitor, size, now);
+        background_refreshed_at = now;
+        damage_box(calculate_panel_box());
+    }
+
+    for (const auto& [ws_id, ws_layout] : overview_layout) {
+        if (g_pCompositor->getWorkspaceByID(ws_id) == nullptr)
+            continue;
+        if (!thumbnails.needs_refresh(ws_id, size))
+            continue;
+        // Only missing thumbnails do not wait. The active workspace changes on nearly every frame
+        // Hyprland draws, redrawing its cell each time would render the workspace twice per frame.
+        const HTThumbnail* thumb = thumbnails.find(ws_id);
+        if (thumb != nullptr && !is_due(thumb->refreshed_at))
+            continue;
+        queue_thumbnail_refresh(ws_id, size, HT_DETAIL_FULL, ws_layout.box);
+    }
+
+    run_thumbnail_refreshes(monitor, now);
+
+    if (next_due.has_value())
+        schedule_refresh(*next_due);
+}
+
+std::optional<HTLayoutBase::HTThumbnailSpec> HTLayoutMinimap::prewarm_spec() {
+    return HTThumbnailSpec {cell_size().round()};
+}
+
+bool HTLayoutMinimap::on_damage(const CBox& box) {
+    if (!HTLayoutBase::on_damage(box))
+        return false;
+
+    // The active workspace is also drawn full size behind the panel
+    damage_box(box);
+    return true;
+}
+
+bool HTLayoutMinimap::is_animating() {
+    return open_perc->isBeingAnimated();
+}
+
+float HTLayoutMinimap::drag_window_scale() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return 1;
+
+    if (should_manage_mouse())
+        return cell_size().x / monitor->m_transformedSize.x;
+
+    return 1;
+}
+
+void HTLayoutMinimap::init_position() {
+    build_overview_layout(HT_VIEW_CLOSED);
+
+    open_perc->setValueAndWarp(0);
+}
+
+Vector2D HTLayoutMinimap::cell_size() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return {};
+
+    // Monitor may not have its final size yet during connect/reconnect
+    if (monitor->m_transformedSize.x < 1 || monitor->m_transformedSize.y < 1)
+        return {};
+
+    const float WIDTH = HTConfig::snapshot().minimap.width * monitor->m_scale;
+    const float GAP_SIZE = HTConfig::snapshot().gap_size * monitor->m_scale;
+    const int COLS = std::max(HTConfig::snapshot().minimap.cols, 1);
+
+    const float cell_width = (WIDTH - (COLS + 1) * GAP_SIZE) / COLS;
+    if (WIDTH > monitor->m_transformedSize.x || cell_width < 1)
+        return {};
+    return {cell_width, cell_width * monitor->m_transformedSize.y / monitor->m_transformedSize.x};
+}
+
+CBox HTLayoutMinimap::calculate_panel_box() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return {};
+
+    const Vector2D cell = cell_size();
+    if (cell.x < 1 || cell.y < 1)
+        return {};
+
+    const float WIDTH = HTConfig::snapshot().minimap.width * monitor->m_scale;
+    const float GAP_SIZE = HTConfig::snapshot().gap_size * monitor->m_scale;
+    const int CORNER = HTConfig::snapshot().minimap.corner;
+    const bool right = CORNER & 1;
+    const bool bottom = CORNER & 2;
+
+    const float height = panel_rows * cell.y + (panel_rows + 1) * GAP_SIZE;
+    const float x = right ? monitor->m_transformedSize.x - WIDTH - GAP_SIZE : GAP_SIZE;
+    const float y = bottom ? monitor->m_transformedSize.y - height - GAP_SIZE : GAP_SIZE;
+    return CBox {x, y, WIDTH, height};
+}
+
+CBox HTLayoutMinimap::calculate_ws_box(int x, int y, HTViewStage stage) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return {};
+
+    const CBox panel_box = calculate_panel_box();
+    if (panel_box.empty())
+        return {};
+
+    const float GAP_SIZE = HTConfig::snapshot().gap_size * monitor->m_scale;
+    const Vector2D cell = cell_size();
+    return CBox {
+        panel_box.x + GAP_SIZE + x * (cell.x + GAP_SIZE),
+        panel_box.y + GAP_SIZE + y * (cell.y + GAP_SIZE),
+        cell.x,
+        cell.y
+    };
+}
+
+void HTLayoutMinimap::build_overview_layout(HTViewStage stage) {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+
+    // Cells do not move with open_perc, every stage has the same layout
+    HTLayoutKey key = base_layout_key(stage);
+    key.content_generation = ht_manager->workspace_generation;
+    if (restore_cached_layout(key))
+        return;
+
+    overview_layout.clear();
+
+    std::vector<WORKSPACEID>& monitor_workspaces = scratch_ws_ids;
+    monitor_workspaces.clear();
+    for (PHLWORKSPACE workspace : g_pCompositor->getWorkspacesCopy()) {
+        if (workspace == nullptr)
+            continue;
+        if (workspace->m_monitor != monitor)
+            continue;
+        if (workspace->m_isSpecialWorkspace)
+            continue;
+        monitor_workspaces.push_back(workspace->m_id);
+    }
+    std::sort(monitor_workspaces.begin(), monitor_workspaces.end());
+
+    // One empty cell to drop windows on a new workspace
+    WORKSPACEID new_id = monitor_workspaces.empty() ? 1 : monitor_workspaces.back() + 1;
+    while (g_pCompositor->getWorkspaceByID(new_id) != nullptr)
+        new_id++;
+    monitor_workspaces.push_back(new_id);
+
+    const int COLS = std::max(HTConfig::snapshot().minimap.cols, 1);
+    panel_rows = ((int)monitor_workspaces.size() + COLS - 1) / COLS;
+
+    for (const auto& [i, ws_id] : monitor_workspaces | std::views::enumerate) {
+        const int x = i % COLS;
+        const int y = i / COLS;
+        overview_layout[ws_id] = {x, y, calculate_ws_box(x, y, stage)};
+    }
+
+    store_cached_layout(key);
+}
+
+void HTLayoutMinimap::render() {
+    HTLayoutBase::render();
+    CScopeGuard x([this] { post_render(); });
+
+    const PHTVIEW par_view = ht_manager->get_view_from_id(view_id);
+    if (par_view == nullptr)
+        return;
+    const PHLMONITOR monitor = par_view->get_monitor();
+    if (monitor == nullptr)
+        return;
+
+    const auto time = Time::steadyNow();
+
+    build_overview_layout(HT_VIEW_ANIMATING);
+    update_visible_windows();
+
+    // The active workspace stays live and full size, the panel goes on top of it
+    const PHLWORKSPACE big_ws = monitor->m_activeWorkspace;
+    render_workspace_at_box(monitor, big_ws, time, {{0, 0}, monitor->m_pixelSize});
+    render_panel(monitor);
+    render_hovered_window_border(monitor);
+
+    // Render dragged window at mouse cursor
+    const PHTVIEW cursor_view = ht_manager->get_view_from_cursor();
+    if (cursor_view == nullptr)
+        return;
+
+    const SP<Layout::ITarget> target = g_layoutManager->dragController()->target();
+    if (target == nullptr)
+        return;
+
+    const PHLWINDOW dragged_window = target->window();
+    if (dragged_window == nullptr)
+        return;
+    const Vector2D mouse_coords = g_pInputManager->getMouseCoordsInternal();
+    const CBox window_box = dragged_window->getWindowMainSurfaceBox()
+                                .translate(-mouse_coords)
+                                .scale(cursor_view->layout->drag_window_scale())
+                                .translate(mouse_coords);
+    if (!window_box.intersection(monitor->logicalBox()).empty())
+        render_drag_window_at_box(dragged_window, monitor, time, window_box);
+}
+
+void HTLayoutMinimap::render_closed() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+
+    // Hyprland already drew the workspace, only the panel is added on top
+    build_overview_layout(HT_VIEW_ANIMATING);
+    render_panel(monitor);
+}
+
+void HTLayoutMinimap::render_panel(PHLMONITOR monitor) {
+    const CBox panel_box = calculate_panel_box();
+    if (panel_box.empty())
+        return;
+
+    const PHLWORKSPACE big_ws = monitor->m_activeWorkspace;
+
+    // Translucent while closed, so the panel does not hide too much of the desktop
+    CRectPassElement::SRectData data;
+    data.color = CHyprColor {HTConfig::snapshot().bg_color}.stripA();
+    data.color.a = 0.5f + 0.5f * std::clamp(open_perc->value(), 0.f, 1.f);
+    data.box = panel_box;
+    g_pHyprRenderer->m_renderPass.add(makeUnique<CRectPassElement>(data));
+
+    begin_texture_batch();
+    CScopeGuard end_batch([this] { end_texture_batch(); });
+    auto add_texture = [this](HTThumbnail* thumb, const CBox& box) {
+        add_cell_texture(thumb->fb.getTexture(), box);
+    };
+
+    CBox mon_box = {{0, 0}, monitor->m_transformedSize};
+    for (const auto& [ws_id, ws_layout] : overview_layout) {
+        if (ws_layout.box.empty() || ws_layout.box.intersection(mon_box).empty())
+            continue;
+
+        // Cells never render their workspace, they wait for pre_render to refresh the thumbnail
+        if (HTThumbnail* background = thumbnails.find_background(); background != nullptr)
+            add_texture(background, ws_layout.box);
+        if (HTThumbnail* thumb = thumbnails.find(ws_id); thumb != nullptr)
+            add_texture(thumb, ws_layout.box);
+
+        render_cell_border(
+            monitor,
+            ws_layout.box,
+            cell_border_gradient(ws_id, big_ws != nullptr && big_ws->m_id == ws_id)
+        );
+    }
+    add_flat_borders();
+}
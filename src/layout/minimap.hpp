@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include <hyprland/src/helpers/time/Time.hpp>
+#include <hyprland/src/managers/eventLoop/EventLoopTimer.hpp>
+
+#include "../types.hpp"
+#include "layout_base.hpp"
+
+// Small grid of the monitor's workspaces in a screen corner, drawn over the live active workspace.
+// Cells only ever show thumbnails, refreshed at most minimap:refresh_rate times per second.
+// The panel stays on screen while the overview is closed, opening it makes the panel opaque and
+// enables dragging windows between cells.
+class HTLayoutMinimap: public HTLayoutBase {
+  private:
+    // 0 when closed, 1 when open, fades the panel background in
+    PHLANIMVAR<float> open_perc;
+
+    // Rows of the panel, from the number of cells in the last layout
+    int panel_rows = 1;
+
+    // Thumbnails wait for minimap:refresh_rate between refreshes
+    Time::steady_tp background_refreshed_at;
+    // Wakes the monitor up when a deferred thumbnail refresh is due
+    SP<CEventLoopTimer> refresh_timer;
+
+    // Panel holding every cell, monitor-local pixels. The same open or closed.
+    CBox calculate_panel_box();
+    // Size of a cell (and of its thumbnail) in pixels
+    Vector2D cell_size();
+    void schedule_refresh(Time::steady_dur delay);
+    // Background, cells and borders of the panel, shared by render and render_closed
+    void render_panel(PHLMONITOR monitor);
+
+  public:
+    HTLayoutMinimap(VIEWID view_id);
+    virtual ~HTLayoutMinimap();
+
+    virtual std::string layout_name();
+
+    virtual CBox calculate_ws_box(int x, int y, HTViewStage stage);
+
+    virtual void close_open_lerp(float perc);
+    virtual void on_show(CallbackFun on_complete);
+    virtual void on_hide(CallbackFun on_complete);
+    virtual void on_move(WORKSPACEID old_id, WORKSPACEID new_id, CallbackFun on_complete);
+
+    virtual bool should_manage_mouse();
+    virtual bool should_render_window(PHLWINDOW window, bool ori_result);
+    virtual void pre_render();
+    virtual bool on_damage(const CBox& box);
+    virtual bool is_animating();
+    virtual float drag_window_scale();
+    virtual void init_position();
+    virtual void build_overview_layout(HTViewStage stage);
+    virtual void render();
+    virtual void render_closed();
+    virtual std::optional<HTThumbnailSpec> prewarm_spec();
+};
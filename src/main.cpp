@@ -19,9 +19,11 @@
 #include <hyprland/src/config/values/ConfigValues.hpp>
 #include <hyprlang.hpp>
 #include <hyprutils/math/Box.hpp>
+#include <hyprutils/math/Region.hpp>
 #include <hyprutils/math/Vector2D.hpp>
 #include <lua.hpp>
 
+#include "bench.hpp"
 #include "config.hpp"
 #include "config/ConfigManager.hpp"
 #include "globals.hpp"
@@ -125,8 +127,8 @@ static SDispatchResult change_layer(std::string arg, bool move_window) {
     if (cursor_view->layout->layout_name() != "grid")
         return {.success = false, .error = "layers are only supported in grid layout"};
 
-    const int LAYERS = HTConfig::value<Config::INTEGER>("grid:layers");
-    const int LOOP_LAYERS = HTConfig::value<Config::INTEGER>("grid:loop_layers");
+    const int LAYERS = HTConfig::snapshot().grid.layers;
+    const int LOOP_LAYERS = HTConfig::snapshot().grid.loop_layers;
     const int original_layer = cursor_view->layout->layer;
 
     int resulting_layer = original_layer;
@@ -267,37 +269,120 @@ static void hook_render_workspace(
                                   ->m_original))(thisptr, monitor, workspace, now, geometry);
         return;
     }
+    // Routed by the monitor's own view: a closed overview renders like stock Hyprland, even while
+    // another monitor has one open
     const PHTVIEW view = ht_manager->get_view_from_monitor(monitor);
-    if ((view != nullptr && view->navigating) || ht_manager->has_active_view()) {
+    if (view != nullptr && (view->active || view->navigating)) {
+        const auto render_start = std::chrono::steady_clock::now();
         view->layout->render();
+        const auto render_time = std::chrono::steady_clock::now() - render_start;
+        view->stats.render_ns +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(render_time).count();
+        view->stats.frames++;
+        view->on_render();
     } else {
         ((render_workspace_t)(render_workspace_hook
                                   ->m_original))(thisptr, monitor, workspace, now, geometry);
+        if (view != nullptr && view->layout->shown_when_closed())
+            view->layout->render_closed();
     }
 }
 
 static bool hook_should_render_window(void* thisptr, PHLWINDOW window, PHLMONITOR monitor) {
     bool ori_result =
         ((should_render_window_t)(should_render_window_hook->m_original))(thisptr, window, monitor);
-    if (ht_manager == nullptr || !ht_manager->has_active_view())
+    if (ht_manager == nullptr)
         return ori_result;
+    // Routed by the monitor's own view, like hook_render_workspace
     const PHTVIEW view = ht_manager->get_view_from_monitor(monitor);
-    if (view == nullptr)
+    if (view == nullptr || (!view->active && !view->navigating))
         return ori_result;
-    return view->layout->should_render_window(window);
+    return view->layout->should_render_window(window, ori_result);
 }
 
 static uint32_t hook_is_solitary_blocked(void* thisptr, bool full) {
-    PHTVIEW view = ht_manager->get_view_from_cursor();
-    if (view == nullptr) {
-        Log::logger->log(Log::ERR, "[Hyprtasking] View is nullptr in hook_is_solitary_blocked");
-        (*(origIsSolitaryBlocked)is_solitary_blocked_hook->m_original)(thisptr, full);
+    // Asked per monitor, only the overview on that monitor blocks solitary and direct scanout
+    const CMonitor* monitor = (CMonitor*)thisptr;
+    const PHTVIEW view =
+        ht_manager == nullptr ? nullptr : ht_manager->get_view_from_id(monitor->m_id);
+    if (view == nullptr)
+        return (*(origIsSolitaryBlocked)is_solitary_blocked_hook->m_original)(thisptr, full);
+    // A layout drawn while closed would not be seen over a directly scanned out window. It hides
+    // while the active workspace is fullscreen, the only case in which that is possible.
+    if (!view->active && !view->navigating) {
+        if (view->layout->shown_when_closed())
+            return CMonitor::SC_UNKNOWN;
+        return (*(origIsSolitaryBlocked)is_solitary_blocked_hook->m_original)(thisptr, full);
     }
 
-    if (view->active || view->navigating) {
-        return CMonitor::SC_UNKNOWN;
+    if (view->active)
+        view->stats.scanout_blocked_active++;
+    else
+        view->stats.scanout_blocked_navigating++;
+    view->stats.last_scanout_block = Time::steadyNow();
+    return CMonitor::SC_UNKNOWN;
+}
+
+static void hook_add_damage_box(void* thisptr, const CBox& box) {
+    if (ht_manager != nullptr && ht_manager->on_damage((CMonitor*)thisptr, box))
+        return;
+    ((add_damage_box_t)(add_damage_box_hook->m_original))(thisptr, box);
+}
+
+static void hook_add_damage_region(void* thisptr, const pixman_region32_t* rg) {
+    if (ht_manager == nullptr || rg == nullptr) {
+        ((add_damage_region_t)(add_damage_region_hook->m_original))(thisptr, rg);
+        return;
     }
-    return (*(origIsSolitaryBlocked)is_solitary_blocked_hook->m_original)(thisptr, full);
+
+    // Attributed rect by rect, the extents of two far apart rects would cover every cell between
+    int rect_count = 0;
+    const pixman_box32_t* rects = pixman_region32_rectangles((pixman_region32_t*)rg, &rect_count);
+    CRegion unattributed;
+    bool any_attributed = false;
+    for (int i = 0; i < rect_count; i++) {
+        const CBox box = {
+            (double)rects[i].x1,
+            (double)rects[i].y1,
+            (double)(rects[i].x2 - rects[i].x1),
+            (double)(rects[i].y2 - rects[i].y1)
+        };
+        if (ht_manager->on_damage((CMonitor*)thisptr, box))
+            any_attributed = true;
+        else
+            unattributed.add(box);
+    }
+
+    if (!any_attributed)
+        ((add_damage_region_t)(add_damage_region_hook->m_original))(thisptr, rg);
+    else if (!unattributed.empty())
+        ((add_damage_region_t)(add_damage_region_hook->m_original))(thisptr, unattributed.pixman());
+}
+
+static std::string hyprctl_stats(eHyprCtlOutputFormat format, std::string request) {
+    if (ht_manager == nullptr)
+        return "ht_manager is null";
+    return ht_manager->stats(format == eHyprCtlOutputFormat::FORMAT_JSON);
+}
+
+static std::string hyprctl_bench(eHyprCtlOutputFormat format, std::string request) {
+    if (ht_manager == nullptr)
+        return "ht_manager is null";
+    return run_bench(
+        g_pCompositor->getMonitorFromCursor(),
+        format == eHyprCtlOutputFormat::FORMAT_JSON
+    );
+}
+
+static void apply_config(bool reloaded);
+
+static void on_pre_render(PHLMONITOR monitor) {
+    if (ht_manager == nullptr)
+        return;
+    // hyprctl keyword changes options without a config reload
+    if (HTConfig::reload_snapshot())
+        apply_config(false);
+    ht_manager->on_pre_render(monitor);
 }
 
 static void on_mouse_button(IPointer::SButtonEvent e, Event::SCallbackInfo& info) {
@@ -310,8 +395,8 @@ static void on_mouse_button(IPointer::SButtonEvent e, Event::SCallbackInfo& info
 
     const bool pressed = e.state == WL_POINTER_BUTTON_STATE_PRESSED;
 
-    const unsigned int drag_button = HTConfig::value<Config::INTEGER>("drag_button");
-    const unsigned int select_button = HTConfig::value<Config::INTEGER>("select_button");
+    const unsigned int drag_button = HTConfig::snapshot().drag_button;
+    const unsigned int select_button = HTConfig::snapshot().select_button;
 
     if (pressed && e.button == drag_button) {
         info.cancelled = ht_manager->start_window_drag();
@@ -372,7 +457,7 @@ static void register_monitors() {
                 view->layout->init_position();
             continue;
         }
-        ht_manager->views.push_back(makeShared<HTView>(monitor->m_id));
+        ht_manager->add_view(monitor);
 
         Log::logger->log(
             LOG,
@@ -392,18 +477,45 @@ static void on_monitor_removed(PHLMONITOR monitor) {
     ht_manager->refresh_all_grid_caches();
 }
 
-static void on_config_reloaded() {
+// Workspace signals hand out either strong or weak references
+static PHLWORKSPACE as_workspace(const PHLWORKSPACE& workspace) {
+    return workspace;
+}
+
+static PHLWORKSPACE as_workspace(const PHLWORKSPACEREF& workspace) {
+    return workspace.lock();
+}
+
+static void on_workspace_created(const auto& workspace) {
+    if (ht_manager == nullptr)
+        return;
+    ht_manager->on_workspace_created(as_workspace(workspace));
+}
+
+static void on_workspace_removed(const auto& workspace) {
     if (ht_manager == nullptr)
         return;
+    ht_manager->on_workspace_removed(as_workspace(workspace));
+}
+
+static void on_workspace_moved(const auto& workspace, PHLMONITOR monitor) {
+    if (ht_manager == nullptr)
+        return;
+    ht_manager->on_workspace_moved(as_workspace(workspace), monitor);
+}
+
+// Options changed, on a config reload (reloaded) or through hyprctl keyword
+static void apply_config(bool reloaded) {
+    ht_manager->config_generation++;
 
     // re-init scale and offset for inactive views, change layout if changed
     for (PHTVIEW& view : ht_manager->views) {
         if (view == nullptr)
             continue;
-        const Config::STRING new_layout = HTConfig::value<Config::STRING>("layout");
-        if (HTConfig::value<Config::INTEGER>("close_overview_on_reload")
+        const Config::STRING new_layout = HTConfig::snapshot().layout;
+        if ((reloaded && HTConfig::snapshot().close_overview_on_reload)
             || view->layout->layout_name() != new_layout) {
-            Log::logger->log(LOG, "[Hyprtasking] Closing overview on config reload");
+            Log::logger->log(LOG, "[Hyprtasking] Closing overview on config change");
             view->hide(false);
             view->change_layout(new_layout);
         }
@@ -412,6 +524,14 @@ static void on_config_reloaded() {
     ht_manager->refresh_all_grid_caches();
 }
 
+static void on_config_reloaded() {
+    if (ht_manager == nullptr)
+        return;
+
+    HTConfig::reload_snapshot();
+    apply_config(true);
+}
+
 static void init_functions() {
     bool success = true;
 
@@ -458,6 +578,27 @@ static void init_functions() {
     Log::logger->log(LOG, "[Hyprtasking] Attempting hook {}", FNS4[0].signature);
     success = is_solitary_blocked_hook->hook() && success;
 
+    // make sure these signatures have "CMonitor"!
+    static auto FNS5 = HyprlandAPI::findFunctionsByName(
+        PHANDLE,
+        "_ZN8CMonitor9addDamageERKN9Hyprutils4Math4CBoxE"
+    );
+    if (FNS5.empty())
+        fail_exit("No CMonitor::addDamage(CBox)");
+    add_damage_box_hook =
+        HyprlandAPI::createFunctionHook(PHANDLE, FNS5[0].address, (void*)hook_add_damage_box);
+    Log::logger->log(LOG, "[Hyprtasking] Attempting hook {}", FNS5[0].signature);
+    success = add_damage_box_hook->hook() && success;
+
+    static auto FNS6 =
+        HyprlandAPI::findFunctionsByName(PHANDLE, "_ZN8CMonitor9addDamageEPK15pixman_region32");
+    if (FNS6.empty())
+        fail_exit("No CMonitor::addDamage(pixman_region32)");
+    add_damage_region_hook =
+        HyprlandAPI::createFunctionHook(PHANDLE, FNS6[0].address, (void*)hook_add_damage_region);
+    Log::logger->log(LOG, "[Hyprtasking] Attempting hook {}", FNS6[0].signature);
+    success = add_damage_region_hook->hook() && success;
+
     if (!success)
         fail_exit("Failed initializing hooks");
 }
@@ -481,6 +622,12 @@ static void register_callbacks() {
     static auto P10 = Event::bus()->m_events.config.reloaded.listen(on_config_reloaded);
     static auto P11 = Event::bus()->m_events.monitor.added.listen(register_monitors);
     static auto P12 = Event::bus()->m_events.monitor.removed.listen(on_monitor_removed);
+
+    static auto P13 = Event::bus()->m_events.render.pre.listen(on_pre_render);
+
+    static auto P14 = Event::bus()->m_events.workspace.created.listen([](const auto& ws) { on_workspace_created(ws); });
+    static auto P15 = Event::bus()->m_events.workspace.removed.listen([](const auto& ws) { on_workspace_removed(ws); });
+    static auto P16 = Event::bus()->m_events.workspace.moveToMonitor.listen([](const auto& ws, PHLMONITOR m) { on_workspace_moved(ws, m); });
 }
 
 
@@ -513,6 +660,14 @@ static void add_dispatchers() {
     add_dispatcher(setlayer);
     add_dispatcher(setlayerwindow);
     HyprlandAPI::addLuaFunction(PHANDLE, "hyprtasking", "is_active", lua_is_active); \
+    HyprlandAPI::registerHyprCtlCommand(
+        PHANDLE,
+        SHyprCtlCommand {.name = "hyprtasking:stats", .exact = true, .fn = hyprctl_stats}
+    );
+    HyprlandAPI::registerHyprCtlCommand(
+        PHANDLE,
+        SHyprCtlCommand {.name = "hyprtasking:bench", .exact = true, .fn = hyprctl_bench}
+    );
 }
 
 #define addConfigValue(T, config, descr, value) do { \
@@ -531,6 +686,9 @@ static void init_config() {
     addConfigValue(CFloatValue, "gap_size", "gap size", 8.f);
 
     addConfigValue(CFloatValue, "border_size", "border size", 4.f);
+    addConfigValue(CIntValue, "hover_border_color", "hover border color", 0x66ffffff);
+    addConfigValue(CIntValue, "flat_borders", "flat borders", 0);
+    addConfigValue(CFloatValue, "thumbnail_budget_ms", "thumbnail budget ms", 3.f);
     addConfigValue(CIntValue, "exit_on_hovered", "exit on hovered", 0);
     addConfigValue(CIntValue, "warp_on_move_window", "warp on move window", 1);
     addConfigValue(CIntValue, "close_overview_on_reload", "close overview on reload", 1);
@@ -553,12 +711,28 @@ static void init_config() {
     addConfigValue(CIntValue, "grid:loop_layers", "loop layers", 1);
     addConfigValue(CIntValue, "grid:loop", "loop", 0);
     addConfigValue(CIntValue, "grid:gaps_use_aspect_ratio", "gaps use aspect ratio", 0);
+    addConfigValue(CFloatValue, "grid:lod_simple_width", "lod simple width", 240.f);
+    addConfigValue(CFloatValue, "grid:lod_placeholder_width", "lod placeholder width", 0.f);
+    addConfigValue(CIntValue, "grid:lod_placeholder_color", "lod placeholder color", 0x40ffffff);
 
     //linear specific
     addConfigValue(CIntValue, "linear:blur", "blur", 1);
     addConfigValue(CFloatValue, "linear:height", "height", 300.f);
     addConfigValue(CFloatValue, "linear:scroll_speed", "scroll speed", 1.f);
     addConfigValue(CIntValue, "linear:top", "top", 0);
+    addConfigValue(CIntValue, "linear:frozen_background", "frozen background", 0);
+
+    // minimap specific
+    addConfigValue(CFloatValue, "minimap:width", "width", 320.f);
+    addConfigValue(CIntValue, "minimap:cols", "cols", 3);
+    addConfigValue(CIntValue, "minimap:corner", "corner", 3);
+    addConfigValue(CFloatValue, "minimap:refresh_rate", "refresh rate", 4.f);
+
+    // thumbnails kept warm while closed
+    addConfigValue(CIntValue, "prewarm:enabled", "enabled", 0);
+    addConfigValue(CIntValue, "prewarm:workspaces", "workspaces", 4);
+    addConfigValue(CFloatValue, "prewarm:refresh_rate", "refresh rate", 1.f);
+    addConfigValue(CFloatValue, "prewarm:vram_mb", "vram mb", 64.f);
 
     // HyprlandAPI::reloadConfig();
 }
@@ -578,6 +752,7 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
         ht_manager->reset();
 
     init_config();
+    HTConfig::reload_snapshot();
     add_dispatchers();
     register_callbacks();
     init_functions();
@@ -1,6 +1,7 @@
 #include "manager.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <unordered_set>
 #include <vector>
 
@@ -19,17 +20,22 @@ HTManager::HTManager() {
     swipe_amt = 0.0;
 }
 
+PHTVIEW HTManager::add_view(PHLMONITOR monitor) {
+    if (monitor == nullptr || monitor->m_id < 0)
+        return nullptr;
+
+    const PHTVIEW view = makeShared<HTView>(monitor->m_id);
+    views.push_back(view);
+    if ((size_t)monitor->m_id >= views_by_id.size())
+        views_by_id.resize(monitor->m_id + 1);
+    views_by_id[monitor->m_id] = view;
+    return view;
+}
+
 PHTVIEW HTManager::get_view_from_monitor(PHLMONITOR monitor) {
     if (monitor == nullptr)
         return nullptr;
-    for (PHTVIEW view : views) {
-        if (view == nullptr)
-            continue;
-        if (view->get_monitor() != monitor)
-            continue;
-        return view;
-    }
-    return nullptr;
+    return get_view_from_id(monitor->m_id);
 }
 
 PHTVIEW HTManager::get_view_from_cursor() {
@@ -37,14 +43,9 @@ PHTVIEW HTManager::get_view_from_cursor() {
 }
 
 PHTVIEW HTManager::get_view_from_id(VIEWID view_id) {
-    for (PHTVIEW view : views) {
-        if (view == nullptr)
-            continue;
-        if (view->monitor_id != view_id)
-            continue;
-        return view;
-    }
-    return nullptr;
+    if (view_id < 0 || (size_t)view_id >= views_by_id.size())
+        return nullptr;
+    return views_by_id[view_id];
 }
 
 PHLWINDOW HTManager::get_window_from_cursor(bool return_focused) {
@@ -68,24 +69,13 @@ PHLWINDOW HTManager::get_window_from_cursor(bool return_focused) {
         );
     }
 
-    const WORKSPACEID ws_id = cursor_view->layout->get_ws_id_from_global(mouse_coords);
-    const PHLWORKSPACE hovered_workspace = g_pCompositor->getWorkspaceByID(ws_id);
-    if (hovered_workspace == nullptr)
-        return nullptr;
-
-    const Vector2D ws_coords = cursor_view->layout->global_to_local_ws_unscaled(mouse_coords, ws_id)
-        + cursor_monitor->m_position;
+    const auto hit_test_start = std::chrono::steady_clock::now();
+    const PHLWINDOW hovered_window = cursor_view->layout->get_window_from_global(mouse_coords);
+    const auto hit_test_time = std::chrono::steady_clock::now() - hit_test_start;
 
-    const PHLWORKSPACEREF o_workspace = cursor_monitor->m_activeWorkspace;
-    cursor_monitor->changeWorkspace(hovered_workspace, true);
-
-    const PHLWINDOW hovered_window = g_pCompositor->vectorToWindowUnified(
-        ws_coords,
-        Desktop::View::RESERVED_EXTENTS | Desktop::View::INPUT_EXTENTS | Desktop::View::ALLOW_FLOATING
-    );
-
-    if (o_workspace != nullptr)
-        cursor_monitor->changeWorkspace(o_workspace.lock(), true);
+    cursor_view->stats.hit_tests++;
+    cursor_view->stats.hit_test_ns +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(hit_test_time).count();
 
     return hovered_window;
 }
@@ -115,7 +105,10 @@ void HTManager::show_cursor_view() {
 void HTManager::reset() {
     swipe_state = HT_SWIPE_NONE;
     swipe_amt = 0.0;
+    drag_preview.stop();
     views.clear();
+    views_by_id.clear();
+    active_views = 0;
 }
 
 void HTManager::refresh_all_grid_caches() {
@@ -141,16 +134,14 @@ void HTManager::refresh_all_grid_caches() {
             g_pCompositor->moveWorkspaceToMonitor(ws, bound);
     }
 
-    std::vector<HTLayoutGrid*> grids;
-    grids.reserve(views.size());
-    for (PHTVIEW view : views) {
-        if (view == nullptr || view->layout == nullptr)
-            continue;
-        if (view->layout->layout_name() != "grid")
-            continue;
-        grids.push_back(static_cast<HTLayoutGrid*>(view->layout.get()));
-    }
+    rule_ws_ids.clear();
+    for (const auto& rule : all_rules)
+        if (rule.m_workspaceId > 0)
+            rule_ws_ids.insert(rule.m_workspaceId);
+    synthetic_hint = 1;
+
     // Sorted iteration so synthetic-ID assignment is stable run-to-run.
+    std::vector<HTLayoutGrid*> grids = grid_layouts();
     std::sort(grids.begin(), grids.end(), [](HTLayoutGrid* a, HTLayoutGrid* b) {
         return a->get_view_id() < b->get_view_id();
     });
@@ -176,20 +167,91 @@ void HTManager::refresh_all_grid_caches() {
     }
 }
 
+std::vector<HTLayoutGrid*> HTManager::grid_layouts() {
+    std::vector<HTLayoutGrid*> grids;
+    grids.reserve(views.size());
+    for (PHTVIEW view : views) {
+        if (view == nullptr || view->layout == nullptr)
+            continue;
+        if (view->layout->layout_name() != "grid")
+            continue;
+        grids.push_back(static_cast<HTLayoutGrid*>(view->layout.get()));
+    }
+    return grids;
+}
+
+WORKSPACEID HTManager::next_synthetic_id() {
+    const std::vector<HTLayoutGrid*> grids = grid_layouts();
+    auto in_use = [&grids, this](WORKSPACEID id) {
+        if (rule_ws_ids.contains(id) || g_pCompositor->getWorkspaceByID(id) != nullptr)
+            return true;
+        return std::ranges::any_of(grids, [id](HTLayoutGrid* g) { return g->has_workspace(id); });
+    };
+    while (in_use(synthetic_hint))
+        synthetic_hint++;
+    return synthetic_hint++;
+}
+
+void HTManager::on_workspace_created(PHLWORKSPACE workspace) {
+    workspace_generation++;
+    if (workspace == nullptr || workspace->m_isSpecialWorkspace || workspace->m_id <= 0)
+        return;
+
+    for (HTLayoutGrid* grid : grid_layouts()) {
+        if (grid->get_view_id() == workspace->monitorID())
+            grid->assign_workspace(workspace->m_id);
+        // Another grid showed this id as an empty slot, it belongs to this monitor now
+        else if (grid->has_workspace(workspace->m_id))
+            grid->release_workspace(workspace->m_id, next_synthetic_id());
+    }
+}
+
+void HTManager::on_workspace_removed(PHLWORKSPACE workspace) {
+    workspace_generation++;
+    if (workspace == nullptr)
+        return;
+    for (HTLayoutGrid* grid : grid_layouts())
+        grid->on_workspace_removed(workspace->m_id);
+}
+
+void HTManager::on_workspace_moved(PHLWORKSPACE workspace, PHLMONITOR monitor) {
+    workspace_generation++;
+    if (workspace == nullptr || monitor == nullptr || workspace->m_isSpecialWorkspace)
+        return;
+    if (workspace->m_id <= 0)
+        return;
+
+    for (HTLayoutGrid* grid : grid_layouts()) {
+        if (grid->get_view_id() == monitor->m_id)
+            grid->assign_workspace(workspace->m_id);
+        else if (grid->has_workspace(workspace->m_id))
+            grid->release_workspace(workspace->m_id, next_synthetic_id());
+    }
+}
+
 void HTManager::remove_view_for_monitor_id(MONITORID mid) {
-    std::erase_if(views, [mid](const PHTVIEW& v) {
-        return v == nullptr || v->monitor_id == mid;
+    std::erase_if(views, [this, mid](const PHTVIEW& v) {
+        if (v == nullptr)
+            return true;
+        if (v->monitor_id != mid)
+            return false;
+        if (v->active)
+            on_view_active_changed(false);
+        return true;
     });
+    if (mid >= 0 && (size_t)mid < views_by_id.size())
+        views_by_id[mid] = nullptr;
 }
 
 bool HTManager::has_active_view() {
-    for (const auto& view : views) {
-        if (view == nullptr)
-            continue;
-        if (view->active)
-            return true;
-    }
-    return false;
+    return active_views > 0;
+}
+
+void HTManager::on_view_active_changed(bool active) {
+    if (active)
+        active_views++;
+    else if (active_views > 0)
+        active_views--;
 }
 
 bool HTManager::cursor_view_active() {
@@ -198,3 +260,119 @@ bool HTManager::cursor_view_active() {
         return false;
     return view->active;
 }
+
+bool HTManager::on_damage(CMonitor* monitor, const CBox& box) {
+    if (monitor == nullptr || block_damage_reporting)
+        return false;
+    const PHTVIEW view = get_view_from_id(monitor->m_id);
+    if (view == nullptr)
+        return false;
+    // A closed layout still drawn on screen keeps its cells fresh, Hyprland keeps the damage
+    if (!view->active && !view->navigating) {
+        if (view->layout->shown_when_closed())
+            view->layout->on_damage(box);
+        return false;
+    }
+
+    // Whole-monitor damage (mode changes, scale changes, ...) also covers gaps and background.
+    // Thumbnails that changed size are refreshed anyway, the rest wait for their surfaces.
+    if (box.containsPoint({0, 0}) && box.containsPoint(monitor->m_pixelSize - Vector2D {1, 1}))
+        return false;
+
+    view->wake();
+    // Damage that belongs to no window or layer (a software cursor, ...) is left to Hyprland
+    if (!view->layout->on_damage(box))
+        return false;
+    // Windows may have moved under the pointer, checked on the next pointer event
+    view->layout->check_hover();
+    return true;
+}
+
+void HTManager::damage_monitor(PHLMONITOR monitor) {
+    if (monitor == nullptr)
+        return;
+    const bool was_blocking = block_damage_reporting;
+    block_damage_reporting = true;
+    g_pHyprRenderer->damageMonitor(monitor);
+    block_damage_reporting = was_blocking;
+}
+
+void HTManager::on_pre_render(PHLMONITOR monitor) {
+    const PHTVIEW view = get_view_from_monitor(monitor);
+    if (view == nullptr)
+        return;
+    if (!view->active && !view->navigating) {
+        if (view->layout->shown_when_closed())
+            view->layout->pre_render();
+        else
+            view->layout->prewarm(monitor, Time::steadyNow());
+        return;
+    }
+    if (drag_preview.needs_refresh())
+        drag_preview.refresh(Time::steadyNow());
+    view->layout->pre_render();
+}
+
+std::string HTManager::stats(bool json) {
+    std::string result = json ? "[" : "";
+    bool first = true;
+    for (const PHTVIEW& view : views) {
+        if (view == nullptr)
+            continue;
+        const PHLMONITOR monitor = view->get_monitor();
+        const std::string name = monitor == nullptr ? "?" : monitor->m_name;
+        const double avg_render_us = view->stats.frames == 0
+            ? 0.0
+            : view->stats.render_ns / 1000.0 / view->stats.frames;
+        const double avg_hit_test_us = view->stats.hit_tests == 0
+            ? 0.0
+            : view->stats.hit_test_ns / 1000.0 / view->stats.hit_tests;
+        const bool scanout_blocked =
+            view->stats.scanout_blocked_active + view->stats.scanout_blocked_navigating > 0;
+        const double last_scanout_block_s = scanout_blocked
+            ? std::chrono::duration<double>(Time::steadyNow() - view->stats.last_scanout_block)
+                  .count()
+            : -1.0;
+
+        const HTLayoutStats& layout_stats = view->layout->stats;
+        const std::vector<std::pair<std::string, std::string>> fields = {
+            {"active", std::format("{}", view->active)},
+            {"settled", std::format("{}", view->settled)},
+            {"settles", std::format("{}", view->stats.settles)},
+            {"suppressed_frames", std::format("{}", view->stats.suppressed_frames)},
+            {"settled_frames", std::format("{}", view->stats.settled_frames)},
+            {"frames", std::format("{}", view->stats.frames)},
+            {"avg_render_us", std::format("{:.2f}", avg_render_us)},
+            {"hit_tests", std::format("{}", view->stats.hit_tests)},
+            {"avg_hit_test_us", std::format("{:.2f}", avg_hit_test_us)},
+            {"scanout_blocked_active", std::format("{}", view->stats.scanout_blocked_active)},
+            {"scanout_blocked_navigating",
+             std::format("{}", view->stats.scanout_blocked_navigating)},
+            {"last_scanout_block_s", std::format("{:.2f}", last_scanout_block_s)},
+            {"layout_hits", std::format("{}", layout_stats.layout_hits)},
+            {"layout_misses", std::format("{}", layout_stats.layout_misses)},
+            {"display_list_hits", std::format("{}", layout_stats.display_list_hits)},
+            {"display_list_misses", std::format("{}", layout_stats.display_list_misses)},
+            {"thumbnail_refreshes", std::format("{}", layout_stats.thumbnail_refreshes)},
+            {"deferred_refreshes", std::format("{}", layout_stats.deferred_refreshes)},
+            {"last_frame_deferred", std::format("{}", layout_stats.last_frame_deferred)},
+            {"prewarm_refreshes", std::format("{}", layout_stats.prewarm_refreshes)},
+            {"prewarm_deferred", std::format("{}", layout_stats.prewarm_deferred)},
+        };
+
+        if (json) {
+            result += std::format(R"({}{{"monitor":"{}")", first ? "" : ",", name);
+            for (const auto& [key, value] : fields)
+                result += std::format(R"(,"{}":{})", key, value);
+            result += "}";
+        } else {
+            result += std::format("monitor {}:\n", name);
+            for (const auto& [key, value] : fields)
+                result += std::format("\t{}: {}\n", key, value);
+        }
+        first = false;
+    }
+    if (json)
+        result += "]";
+    return result;
+}
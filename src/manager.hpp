@@ -3,7 +3,12 @@
 #include <hyprland/src/desktop/DesktopTypes.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
 
+#include <unordered_set>
+
 #include "overview.hpp"
+#include "thumbnail.hpp"
+
+class HTLayoutGrid;
 
 class HTManager {
   public:
@@ -11,6 +16,9 @@ class HTManager {
 
     std::vector<PHTVIEW> views;
 
+    // Create the view for monitor, which must not have one yet
+    PHTVIEW add_view(PHLMONITOR monitor);
+
     PHTVIEW get_view_from_monitor(PHLMONITOR pMonitor);
     PHTVIEW get_view_from_cursor();
     PHTVIEW get_view_from_id(VIEWID view_id);
@@ -24,6 +32,10 @@ class HTManager {
     void show_cursor_view();
 
     void refresh_all_grid_caches();
+    // Keep grid slots up to date between full refreshes
+    void on_workspace_created(PHLWORKSPACE workspace);
+    void on_workspace_removed(PHLWORKSPACE workspace);
+    void on_workspace_moved(PHLWORKSPACE workspace, PHLMONITOR monitor);
     void remove_view_for_monitor_id(MONITORID mid);
 
     bool start_window_drag();
@@ -44,6 +56,47 @@ class HTManager {
     bool swipe_update(IPointer::SSwipeUpdateEvent e);
     bool swipe_end();
 
+    // Whether a workspace rule names ws_id, as of the last refresh_all_grid_caches
+    bool is_rule_ws(WORKSPACEID ws_id) const { return rule_ws_ids.contains(ws_id); }
+
+    // Constant time, from the count kept by HTView::set_active
     bool has_active_view();
+    void on_view_active_changed(bool active);
     bool cursor_view_active();
+
+    // Per view counters, for `hyprctl hyprtasking:stats`
+    std::string stats(bool json);
+
+    // Bumped on config reload and whenever workspaces are created, removed or moved, layouts
+    // rebuild when these change
+    uint64_t config_generation = 0;
+    uint64_t workspace_generation = 0;
+
+    // Set while hyprtasking damages monitors itself, so it is not mistaken for client damage
+    bool block_damage_reporting = false;
+    // Damage reported on a monitor, box is monitor-local and in pixels.
+    // Returns true if the damage was translated into overview cells and should be dropped.
+    bool on_damage(CMonitor* monitor, const CBox& box);
+    // Damage the whole monitor without it being reported as client damage
+    void damage_monitor(PHLMONITOR monitor);
+    void on_pre_render(PHLMONITOR monitor);
+
+    HTDragPreview drag_preview;
+
+  private:
+    // views indexed by MONITORID (the view id), null where there is no view
+    std::vector<PHTVIEW> views_by_id;
+    // View whose layout holds the hover highlight, see on_mouse_move
+    VIEWID hover_view_id = -1;
+    // Views with active set, so has_active_view does not walk views on every render hook
+    size_t active_views = 0;
+
+    // Ids bound by workspace rules, never handed out as synthetic ids
+    std::unordered_set<WORKSPACEID> rule_ws_ids;
+    // Synthetic ids below this were already checked, reset by refresh_all_grid_caches
+    WORKSPACEID synthetic_hint = 1;
+
+    std::vector<HTLayoutGrid*> grid_layouts();
+    // An id that is not a workspace, not bound by a rule and not in any grid
+    WORKSPACEID next_synthetic_id();
 };
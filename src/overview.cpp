@@ -14,6 +14,7 @@
 #include "globals.hpp"
 #include "layout/grid.hpp"
 #include "layout/linear.hpp"
+#include "layout/minimap.hpp"
 #include "src/desktop/state/FocusState.hpp"
 
 HTView::HTView(MONITORID in_monitor_id) {
@@ -21,11 +22,20 @@ HTView::HTView(MONITORID in_monitor_id) {
     active = false;
     closing = false;
     navigating = false;
+    settled = false;
 
-    std::string val = HTConfig::value<Config::STRING>("layout");
+    std::string val = HTConfig::snapshot().layout;
     change_layout(val);
 }
 
+void HTView::set_active(bool value) {
+    if (active == value)
+        return;
+    active = value;
+    if (ht_manager != nullptr)
+        ht_manager->on_view_active_changed(value);
+}
+
 void HTView::change_layout(const std::string& layout_name) {
     if (layout != nullptr && layout->layout_name() == layout_name) {
         layout->init_position();
@@ -36,9 +46,11 @@ void HTView::change_layout(const std::string& layout_name) {
         layout = makeShared<HTLayoutGrid>(monitor_id);
     } else if (layout_name == "linear") {
         layout = makeShared<HTLayoutLinear>(monitor_id);
+    } else if (layout_name == "minimap") {
+        layout = makeShared<HTLayoutMinimap>(monitor_id);
     } else {
         fail_exit(
-            "Bad overview layout name {}, supported ones are 'grid' and 'linear'",
+            "Bad overview layout name {}, supported ones are 'grid', 'linear' and 'minimap'",
             layout_name
         );
     }
@@ -58,7 +70,7 @@ void HTView::do_exit_behavior(bool exit_on_mouse) {
         return layout->get_ws_id_from_global(mouse_coords);
     };
 
-    const int EXIT_ON_HOVERED = HTConfig::value<Config::INTEGER>("exit_on_hovered");
+    const int EXIT_ON_HOVERED = HTConfig::snapshot().exit_on_hovered;
 
     const WORKSPACEID ws_id =
         (exit_on_mouse || EXIT_ON_HOVERED) ? try_get_hover_id() : monitor->m_activeWorkspace->m_id;
@@ -80,9 +92,10 @@ void HTView::show(bool recalculate) {
     if (active_workspace == nullptr)
         return;
 
-    active = true;
+    set_active(true);
     closing = false;
     navigating = false;
+    wake();
 
     if (recalculate) {
         layout->init_position();
@@ -91,7 +104,7 @@ void HTView::show(bool recalculate) {
 
     Cursor::overrideController->setOverride("left_ptr", Cursor::CURSOR_OVERRIDE_UNKNOWN);
 
-    g_pHyprRenderer->damageMonitor(monitor);
+    ht_manager->damage_monitor(monitor);
     g_pCompositor->scheduleFrameForMonitor(monitor);
 }
 
@@ -104,19 +117,21 @@ void HTView::hide(bool exit_on_mouse) {
         return;
 
     do_exit_behavior(exit_on_mouse);
+    layout->clear_hover();
 
-    active = true;
+    set_active(true);
     closing = true;
     navigating = false;
+    wake();
 
     layout->on_hide([this](auto self) {
-        active = false;
+        set_active(false);
         closing = false;
     });
 
     Cursor::overrideController->unsetOverride(Cursor::CURSOR_OVERRIDE_UNKNOWN);
 
-    g_pHyprRenderer->damageMonitor(monitor);
+    ht_manager->damage_monitor(monitor);
     g_pCompositor->scheduleFrameForMonitor(monitor);
 }
 
@@ -163,13 +178,14 @@ void HTView::move_id(WORKSPACEID ws_id, bool move_window) {
 
     if (move_window) {
         Desktop::focusState()->fullWindowFocus(hovered_window, Desktop::FOCUS_REASON_CLICK);
-        warp = *CConfigValue<Config::INTEGER>("plugin:hyprtasking:warp_on_move_window");
+        warp = HTConfig::snapshot().warp_on_move_window;
     } else {
         warp = *CConfigValue<Config::INTEGER>("cursor:warp_on_change_workspace");
     }
     warp_window(warp, hovered_window);
 
     navigating = true;
+    wake();
     layout->on_move(active_workspace->m_id, other_workspace->m_id, [this](auto self) {
         navigating = false;
     });
@@ -194,15 +210,48 @@ void HTView::move(std::string arg, bool move_window) {
     } else {
         layout->build_overview_layout(HT_VIEW_CLOSED);
     }
-    const auto ws_layout = layout->overview_layout[source_ws_id];
+    const auto ws_layout = layout->ws_layout(source_ws_id);
     const WORKSPACEID id = layout->get_ws_id_in_direction(ws_layout.x, ws_layout.y, arg);
 
     move_id(id, move_window);
 }
 
 PHLMONITOR HTView::get_monitor() {
-    const PHLMONITOR monitor = g_pCompositor->getMonitorFromID(monitor_id);
-    if (monitor == nullptr)
+    if (const PHLMONITOR cached = cached_monitor.lock(); cached != nullptr)
+        return cached;
+
+    const PHLMONITOR found = g_pCompositor->getMonitorFromID(monitor_id);
+    if (found == nullptr)
         Log::logger->log(Log::WARN, "[Hyprtasking] Returning null monitor from get_monitor!");
-    return monitor;
+    cached_monitor = found;
+    return found;
+}
+
+void HTView::on_render() {
+    const PHLMONITOR monitor = get_monitor();
+    if (monitor == nullptr)
+        return;
+
+    if (layout->is_animating()) {
+        wake();
+        ht_manager->damage_monitor(monitor);
+        return;
+    }
+    // Something else (client damage, the hover highlight) asked for this frame
+    if (settled)
+        stats.settled_frames++;
+    // Every overview frame used to damage the whole monitor and so ask for the next one
+    stats.suppressed_frames++;
+    settle();
+}
+
+void HTView::settle() {
+    if (settled)
+        return;
+    settled = true;
+    stats.settles++;
+}
+
+void HTView::wake() {
+    settled = false;
 }
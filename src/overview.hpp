@@ -4,24 +4,34 @@
 #include <hyprland/src/SharedDefs.hpp>
 #include <hyprland/src/desktop/DesktopTypes.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
+#include <hyprland/src/helpers/time/Time.hpp>
 #include <hyprland/src/macros.hpp>
 #include <hyprutils/math/Box.hpp>
 #include <hyprutils/math/Vector2D.hpp>
 
 #include "layout/layout_base.hpp"
+#include "stats.hpp"
 
 typedef long VIEWID;
 
 class HTView {
   public:
     bool closing;
+    // Only written through set_active, the manager keeps a count of active views
     bool active;
     bool navigating;
+    // Animations finished and nothing changed since: the render path stops scheduling frames
+    // until input, an animation or client damage wakes the view up
+    bool settled;
+
+    HTViewStats stats;
 
     HTView(MONITORID in_monitor_id);
 
     void change_layout(const std::string& layout_name);
 
+    void set_active(bool value);
+
     MONITORID monitor_id;
 
     SP<HTLayoutBase> layout;
@@ -31,12 +41,21 @@ class HTView {
 
     PHLMONITOR get_monitor();
 
+    // Called after the layout rendered a frame, schedules the next one while animating
+    void on_render();
+    void settle();
+    void wake();
+
     void show(bool recalculate = true);
     void hide(bool exit_on_mouse);
 
     void move_id(WORKSPACEID ws_id, bool move_window);
     // arg is up, down, left, right;
     void move(std::string arg, bool move_window);
+
+  private:
+    // Resolved once, get_monitor only looks the id up again if the monitor went away
+    PHLMONITORREF cached_monitor;
 };
 
 typedef SP<HTView> PHTVIEW;
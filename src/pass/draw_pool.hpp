@@ -0,0 +1,27 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+// Storage for the draws of a pass element. Hyprland frees pass elements after every frame, so the
+// element takes its vector from the pool and gives it back when it is destroyed. The next frame
+// then reuses its capacity instead of growing a new vector. Only depends on the standard library,
+// so tests/ can build it without Hyprland.
+template<typename T>
+class HTDrawPool {
+  public:
+    // Empty vector with the capacity of the largest one given back so far
+    std::vector<T> acquire() {
+        std::vector<T> items = std::exchange(spare, {});
+        items.clear();
+        return items;
+    }
+
+    void release(std::vector<T>&& items) {
+        if (items.capacity() >= spare.capacity())
+            spare = std::move(items);
+    }
+
+  private:
+    std::vector<T> spare;
+};
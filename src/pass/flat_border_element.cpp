@@ -0,0 +1,47 @@
+#include "flat_border_element.hpp"
+
+#include <hyprland/src/render/OpenGL.hpp>
+
+void HTFlatBorderElement::add(const CBox& box, double width, const CHyprColor& color) {
+    if (box.empty() || width <= 0 || color.a <= 0.f)
+        return;
+
+    HTColorGroup* group = nullptr;
+    for (HTColorGroup& existing : groups) {
+        if (existing.color == color) {
+            group = &existing;
+            break;
+        }
+    }
+    if (group == nullptr)
+        group = &groups.emplace_back(HTColorGroup {color, CRegion {}});
+
+    // Four strips around the box
+    group->strips.add(CBox {box.x - width, box.y - width, box.w + width * 2, width});
+    group->strips.add(CBox {box.x - width, box.y + box.h, box.w + width * 2, width});
+    group->strips.add(CBox {box.x - width, box.y, width, box.h});
+    group->strips.add(CBox {box.x + box.w, box.y, width, box.h});
+}
+
+std::vector<UP<IPassElement>> HTFlatBorderElement::draw() {
+    for (HTColorGroup& group : groups) {
+        // Only what the frame repaints, the rect covers every strip and is clipped to them
+        group.strips.intersect(g_pHyprOpenGL->m_renderData.damage);
+        if (group.strips.empty())
+            continue;
+        g_pHyprOpenGL->renderRect(
+            group.strips.getExtents(),
+            group.color,
+            {.damage = &group.strips}
+        );
+    }
+    return {};
+}
+
+bool HTFlatBorderElement::needsLiveBlur() {
+    return false;
+}
+
+bool HTFlatBorderElement::needsPrecomputeBlur() {
+    return false;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+#include <hyprland/src/helpers/Color.hpp>
+#include <hyprland/src/render/pass/PassElement.hpp>
+#include <hyprutils/math/Box.hpp>
+#include <hyprutils/math/Region.hpp>
+
+// Solid cell borders (see flat_borders) of a whole frame. The strips of all borders of one color
+// are merged into a region, which is drawn with a single rect draw clipped to it.
+class HTFlatBorderElement: public IPassElement {
+  public:
+    HTFlatBorderElement() = default;
+    virtual ~HTFlatBorderElement() = default;
+
+    // box is in monitor-local pixels, a border width pixels wide is drawn around it
+    void add(const CBox& box, double width, const CHyprColor& color);
+    bool empty() const { return groups.empty(); }
+
+    virtual std::vector<UP<IPassElement>> draw() override;
+    virtual bool needsLiveBlur() override;
+    virtual bool needsPrecomputeBlur() override;
+    virtual ePassElementType type() override {
+        return EK_CUSTOM;
+    }
+
+    virtual const char* passName() override {
+        return "HTFlatBorderElement";
+    }
+
+  private:
+    struct HTColorGroup {
+        CHyprColor color;
+        CRegion strips;
+    };
+
+    // One per color, a frame has at most the active, inactive and hover ones
+    std::vector<HTColorGroup> groups;
+};
@@ -0,0 +1,36 @@
+#include "texture_batch_element.hpp"
+
+#include <hyprland/src/render/OpenGL.hpp>
+
+HTTextureBatchElement::HTTextureBatchElement(SP<HTPool> new_pool) {
+    pool = new_pool;
+    if (new_pool != nullptr)
+        draws = new_pool->acquire();
+}
+
+HTTextureBatchElement::~HTTextureBatchElement() {
+    // The textures are released now, the capacity goes back for the next frame
+    draws.clear();
+    if (const SP<HTPool> locked = pool.lock(); locked != nullptr)
+        locked->release(std::move(draws));
+}
+
+void HTTextureBatchElement::add(SP<CTexture> tex, const CBox& box) {
+    if (tex == nullptr || box.empty())
+        return;
+    draws.push_back({std::move(tex), box});
+}
+
+std::vector<UP<IPassElement>> HTTextureBatchElement::draw() {
+    for (const HTTextureDraw& texture_draw : draws)
+        g_pHyprOpenGL->renderTexture(texture_draw.tex, texture_draw.box, {.a = 1.f});
+    return {};
+}
+
+bool HTTextureBatchElement::needsLiveBlur() {
+    return false;
+}
+
+bool HTTextureBatchElement::needsPrecomputeBlur() {
+    return false;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include <hyprland/src/render/Texture.hpp>
+#include <hyprland/src/render/pass/PassElement.hpp>
+#include <hyprutils/math/Box.hpp>
+
+#include "draw_pool.hpp"
+
+// Thumbnails of every overview cell of a frame in one pass element, instead of a CTexPassElement
+// per texture. Its storage comes from a pool owned by the layout, see HTDrawPool.
+class HTTextureBatchElement: public IPassElement {
+  public:
+    struct HTTextureDraw {
+        SP<CTexture> tex;
+        CBox box;
+    };
+    using HTPool = HTDrawPool<HTTextureDraw>;
+
+    HTTextureBatchElement(SP<HTPool> pool);
+    virtual ~HTTextureBatchElement();
+
+    // box is in monitor-local pixels
+    void add(SP<CTexture> tex, const CBox& box);
+
+    virtual std::vector<UP<IPassElement>> draw() override;
+    virtual bool needsLiveBlur() override;
+    virtual bool needsPrecomputeBlur() override;
+    virtual ePassElementType type() override {
+        return EK_CUSTOM;
+    }
+
+    virtual const char* passName() override {
+        return "HTTextureBatchElement";
+    }
+
+  private:
+    WP<HTPool> pool;
+    std::vector<HTTextureDraw> draws;
+};
@@ -6,7 +6,9 @@
 #include <hyprland/src/managers/input/InputManager.hpp>
 #include <hyprland/src/render/OpenGL.hpp>
 #include <hyprland/src/render/Renderer.hpp>
+#include <hyprland/src/render/pass/RectPassElement.hpp>
 #include <hyprland/src/render/pass/RendererHintsPassElement.hpp>
+#include <hyprland/src/render/pass/TexPassElement.hpp>
 #include <hyprutils/math/Vector2D.hpp>
 
 #include "globals.hpp"
@@ -14,11 +16,14 @@
 #include "types.hpp"
 
 using namespace Render;
-// Note: box is relative to (0, 0), not monitor
-void render_window_at_box(PHLWINDOW window, PHLMONITOR monitor, const Time::steady_tp& time, CBox box) {
-    if (!window || !monitor)
-        return;
 
+static void add_window_at_box(
+    PHLWINDOW window,
+    PHLMONITOR monitor,
+    const Time::steady_tp& time,
+    CBox box,
+    bool decorate
+) {
     box.x -= monitor->m_position.x;
     box.y -= monitor->m_position.y;
 
@@ -34,13 +39,12 @@ void render_window_at_box(PHLWINDOW window, PHLMONITOR monitor, const Time::stea
         makeUnique<CRendererHintsPassElement>(CRendererHintsPassElement::SData {data})
     );
 
-    g_pHyprRenderer->damageWindow(window);
     ((render_window_t)render_window)(
         g_pHyprRenderer.get(),
         window,
         monitor,
         time,
-        true,
+        decorate,
         RENDER_PASS_MAIN,
         false,
         true
@@ -50,3 +54,192 @@ void render_window_at_box(PHLWINDOW window, PHLMONITOR monitor, const Time::stea
         CRendererHintsPassElement::SData {SRenderModifData {}}
     ));
 }
+
+// Note: box is relative to (0, 0), not monitor
+void render_window_at_box(PHLWINDOW window, PHLMONITOR monitor, const Time::steady_tp& time, CBox box) {
+    if (!window || !monitor)
+        return;
+
+    // Not client damage: the window only moved with the cursor
+    const bool was_blocking = ht_manager->block_damage_reporting;
+    ht_manager->block_damage_reporting = true;
+    g_pHyprRenderer->damageWindow(window);
+    ht_manager->block_damage_reporting = was_blocking;
+    add_window_at_box(window, monitor, time, box, true);
+}
+
+// Call fn on the mapped windows of workspace that Hyprland would draw, bottom to top, with their
+// real box scaled into cell_box (monitor-local pixels)
+template<typename Fn>
+static void for_each_window_in_cell(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const CBox& cell_box,
+    Fn&& fn
+) {
+    const double ratio = cell_box.w / monitor->m_transformedSize.x;
+    for (const bool floating : {false, true}) {
+        for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+            if (window == nullptr || !window->m_isMapped || window->isHidden())
+                continue;
+            if (window->m_workspace != workspace || window->m_isFloating != floating)
+                continue;
+            if (!g_pHyprRenderer->shouldRenderWindow(window, monitor))
+                continue;
+            const Vector2D pos = (window->m_realPosition->value() - monitor->m_position)
+                * monitor->m_scale * ratio;
+            const Vector2D size = window->m_realSize->value() * monitor->m_scale * ratio;
+            fn(window, CBox {cell_box.pos() + pos, size});
+        }
+    }
+}
+
+void render_workspace_windows_at_box(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const Time::steady_tp& time,
+    const CBox& cell_box
+) {
+    if (monitor == nullptr || workspace == nullptr || monitor->m_transformedSize.x < 1)
+        return;
+
+    const bool was_blocking = ht_manager->block_damage_reporting;
+    ht_manager->block_damage_reporting = true;
+    HTWorkspaceRenderScope scope(monitor, workspace);
+    ht_manager->block_damage_reporting = was_blocking;
+
+    for_each_window_in_cell(monitor, workspace, cell_box, [&](PHLWINDOW window, CBox box) {
+        // Back to global coordinates, which add_window_at_box expects
+        box.scale(1 / monitor->m_scale).translate(monitor->m_position);
+        add_window_at_box(window, monitor, time, box, false);
+    });
+}
+
+void render_workspace_placeholders(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const CBox& cell_box,
+    const CHyprColor& color
+) {
+    if (monitor == nullptr || workspace == nullptr || monitor->m_transformedSize.x < 1)
+        return;
+
+    for_each_window_in_cell(monitor, workspace, cell_box, [&color](PHLWINDOW window, CBox box) {
+        CRectPassElement::SRectData data;
+        data.color = color;
+        data.box = box;
+        g_pHyprRenderer->m_renderPass.add(makeUnique<CRectPassElement>(data));
+    });
+}
+
+void render_drag_window_at_box(
+    PHLWINDOW window,
+    PHLMONITOR monitor,
+    const Time::steady_tp& time,
+    CBox box
+) {
+    if (!window || !monitor)
+        return;
+
+    HTThumbnail* preview = ht_manager->drag_preview.find(window);
+    if (preview == nullptr) {
+        render_window_at_box(window, monitor, time, box);
+        return;
+    }
+
+    // The window moves with the cursor, its real box contains the scaled preview
+    const bool was_blocking = ht_manager->block_damage_reporting;
+    ht_manager->block_damage_reporting = true;
+    g_pHyprRenderer->damageWindow(window);
+    ht_manager->block_damage_reporting = was_blocking;
+
+    CTexPassElement::SRenderData data;
+    data.tex = preview->fb.getTexture();
+    data.box = {(box.pos() - monitor->m_position) * monitor->m_scale, box.size() * monitor->m_scale};
+    data.a = 1.f;
+    g_pHyprRenderer->m_renderPass.add(makeUnique<CTexPassElement>(data));
+}
+
+HTWorkspaceRenderScope::HTWorkspaceRenderScope(PHLMONITOR monitor, PHLWORKSPACE workspace) :
+    monitor(monitor), workspace(workspace) {
+    prev_active = monitor->m_activeWorkspace;
+    workspace_visible = workspace->m_visible;
+    prev_active_visible = prev_active != nullptr && prev_active->m_visible;
+
+    // Windows of the real active workspace (e.g. pinned ones) should not leak into other cells
+    if (prev_active != nullptr && prev_active != workspace)
+        prev_active->m_visible = false;
+    workspace->m_visible = true;
+    monitor->m_activeWorkspace = workspace;
+
+    // A hidden workspace rests wherever its last out-animation left it. Move it back to its
+    // neutral position once; Hyprland sets the start of the next in-animation itself, so this
+    // does not leak into workspace switching. Afterwards, no animation is touched.
+    if (workspace->m_alpha->isBeingAnimated() || workspace->m_alpha->value() != 1.f)
+        workspace->m_alpha->setValueAndWarp(1.f);
+    if (workspace->m_renderOffset->isBeingAnimated()
+        || workspace->m_renderOffset->value() != Vector2D {0, 0})
+        workspace->m_renderOffset->setValueAndWarp(Vector2D {0, 0});
+}
+
+HTWorkspaceRenderScope::~HTWorkspaceRenderScope() {
+    workspace->m_visible = workspace_visible;
+    if (prev_active != nullptr)
+        prev_active->m_visible = prev_active_visible;
+    monitor->m_activeWorkspace = prev_active;
+}
+
+HTLayerHideScope::HTLayerHideScope(PHLMONITOR monitor) : monitor(monitor) {
+    // background, bottom, top; overlay stays with the workspace
+    for (size_t i = 0; i < HIDDEN_LAYERS; i++)
+        std::swap(layers[i], monitor->m_layerSurfaceLayers[i]);
+}
+
+HTLayerHideScope::~HTLayerHideScope() {
+    for (size_t i = 0; i < HIDDEN_LAYERS; i++)
+        std::swap(layers[i], monitor->m_layerSurfaceLayers[i]);
+}
+
+HTOverlayHideScope::HTOverlayHideScope(PHLMONITOR monitor) : monitor(monitor) {
+    std::swap(layer, monitor->m_layerSurfaceLayers[HTLayerHideScope::HIDDEN_LAYERS]);
+}
+
+HTOverlayHideScope::~HTOverlayHideScope() {
+    std::swap(layer, monitor->m_layerSurfaceLayers[HTLayerHideScope::HIDDEN_LAYERS]);
+}
+
+void render_workspace_at_box(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const Time::steady_tp& time,
+    const CBox& box
+) {
+    if (monitor == nullptr)
+        return;
+
+    if (workspace == nullptr) {
+        // If pWorkspace is null, then just render the layers
+        ((render_workspace_t)(render_workspace_hook->m_original))(
+            g_pHyprRenderer.get(),
+            monitor,
+            workspace,
+            time,
+            box
+        );
+        return;
+    }
+
+    // Warping the workspace animations above may damage the monitor, which is not client damage
+    const bool was_blocking = ht_manager->block_damage_reporting;
+    ht_manager->block_damage_reporting = true;
+    HTWorkspaceRenderScope scope(monitor, workspace);
+    ht_manager->block_damage_reporting = was_blocking;
+
+    ((render_workspace_t)(render_workspace_hook->m_original))(
+        g_pHyprRenderer.get(),
+        monitor,
+        workspace,
+        time,
+        box
+    );
+}
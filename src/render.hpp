@@ -5,4 +5,79 @@
 #include <hyprland/src/helpers/time/Time.hpp>
 #include <hyprutils/math/Box.hpp>
 
+#include "types.hpp"
+
 void render_window_at_box(PHLWINDOW window, PHLMONITOR monitor, const Time::steady_tp& time, CBox box);
+// Same as render_window_at_box, but composites the drag preview snapshot if there is one
+void render_drag_window_at_box(
+    PHLWINDOW window,
+    PHLMONITOR monitor,
+    const Time::steady_tp& time,
+    CBox box
+);
+
+// Hyprland only renders the active, visible workspace of a monitor. For its lifetime, this makes
+// workspace the one that renderWorkspace draws, without starting any workspace animations.
+class HTWorkspaceRenderScope {
+  public:
+    HTWorkspaceRenderScope(PHLMONITOR monitor, PHLWORKSPACE workspace);
+    ~HTWorkspaceRenderScope();
+
+  private:
+    PHLMONITOR monitor;
+    PHLWORKSPACE workspace;
+    PHLWORKSPACE prev_active;
+    bool workspace_visible;
+    bool prev_active_visible;
+};
+
+// Hides the background, bottom and top layers of a monitor for its lifetime, so that a workspace
+// can be rendered without them (they are cached once per monitor, see HTThumbnailCache)
+class HTLayerHideScope {
+  public:
+    HTLayerHideScope(PHLMONITOR monitor);
+    ~HTLayerHideScope();
+
+    static constexpr size_t HIDDEN_LAYERS = 3;
+
+  private:
+    PHLMONITOR monitor;
+    std::array<std::vector<PHLLSREF>, HIDDEN_LAYERS> layers;
+};
+
+// Hides the overlay layer of a monitor for its lifetime. The shared background thumbnail is drawn
+// without it, workspace thumbnails already carry the overlay surfaces.
+class HTOverlayHideScope {
+  public:
+    HTOverlayHideScope(PHLMONITOR monitor);
+    ~HTOverlayHideScope();
+
+  private:
+    PHLMONITOR monitor;
+    std::vector<PHLLSREF> layer;
+};
+
+// Render workspace (or only the layers if nullptr) with the original renderWorkspace at box
+void render_workspace_at_box(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const Time::steady_tp& time,
+    const CBox& box
+);
+
+// Render only the window surfaces of workspace, scaled into cell_box (monitor-local pixels), see
+// HT_DETAIL_SIMPLE
+void render_workspace_windows_at_box(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const Time::steady_tp& time,
+    const CBox& cell_box
+);
+// Draw a rectangle of color for every window of workspace, scaled into cell_box (monitor-local
+// pixels), see HT_DETAIL_PLACEHOLDER
+void render_workspace_placeholders(
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    const CBox& cell_box,
+    const CHyprColor& color
+);
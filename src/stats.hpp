@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include <hyprland/src/helpers/time/Time.hpp>
+
+// Counters kept per view, printed by `hyprctl hyprtasking:stats`
+struct HTViewStats {
+    // Times the open overview settled and stopped scheduling frames
+    uint64_t settles = 0;
+    // Overview frames that did not ask for the next one because nothing was animating. Each of
+    // them used to damage the whole monitor.
+    uint64_t suppressed_frames = 0;
+    // Frames drawn while settled anyway, asked for by client damage, input or the hover highlight
+    uint64_t settled_frames = 0;
+
+    // Overview frames built by the layout, and the CPU time spent building them
+    uint64_t frames = 0;
+    uint64_t render_ns = 0;
+
+    // Hovered window lookups in the overview, and the time spent in them
+    uint64_t hit_tests = 0;
+    uint64_t hit_test_ns = 0;
+
+    // Times solitary and direct scanout were refused on this monitor because the overview was
+    // open (or closing), or because a gesture was navigating, and when that last happened
+    uint64_t scanout_blocked_active = 0;
+    uint64_t scanout_blocked_navigating = 0;
+    Time::steady_tp last_scanout_block;
+};
+
+// Counters kept per layout, printed with the view stats
+struct HTLayoutStats {
+    // build_overview_layout calls served from the cache, and those that rebuilt the layout
+    uint64_t layout_hits = 0;
+    uint64_t layout_misses = 0;
+    // Grid frames that replayed the display list, and those that rebuilt it
+    uint64_t display_list_hits = 0;
+    uint64_t display_list_misses = 0;
+
+    // Thumbnails refreshed, and refreshes pushed to a later frame by thumbnail_budget_ms (in
+    // total and in the last frame that refreshed any), in frames that show the layout
+    uint64_t thumbnail_refreshes = 0;
+    uint64_t deferred_refreshes = 0;
+    uint64_t last_frame_deferred = 0;
+    // The same for prewarm passes while the overview is closed
+    uint64_t prewarm_refreshes = 0;
+    uint64_t prewarm_deferred = 0;
+};
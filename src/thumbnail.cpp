@@ -0,0 +1,373 @@
+#include "thumbnail.hpp"
+
+#include <algorithm>
+#include <functional>
+
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/desktop/view/LayerSurface.hpp>
+#include <hyprland/src/protocols/core/Compositor.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
+#include <hyprland/src/render/Renderer.hpp>
+#include <hyprutils/utils/ScopeGuard.hpp>
+
+#include "globals.hpp"
+#include "render.hpp"
+#include "types.hpp"
+
+using Hyprutils::Utils::CScopeGuard;
+
+HTSurfaceWatch::HTSurfaceWatch(SP<CWLSurfaceResource> new_root, std::function<void()> callback) {
+    root = new_root;
+    on_commit = std::move(callback);
+    attach_tree();
+}
+
+void HTSurfaceWatch::attach_tree() {
+    const SP<CWLSurfaceResource> locked = root.lock();
+    if (locked == nullptr) {
+        surfaces.clear();
+        return;
+    }
+
+    // Listeners of surfaces still in the tree are kept, the root's may be the one calling this
+    std::unordered_map<const CWLSurfaceResource*, HTWatchedSurface> attached;
+    locked->breadthfirst(
+        [this, &attached, &locked](SP<CWLSurfaceResource> surface, const Vector2D&, void*) {
+            const auto it = surfaces.find(surface.get());
+            if (it != surfaces.end() && it->second.surface.lock() == surface) {
+                attached.emplace(surface.get(), std::move(it->second));
+                return;
+            }
+
+            HTWatchedSurface watched;
+            watched.surface = surface;
+            if (surface == locked) {
+                watched.listener = surface->m_events.commit.listen([this] {
+                    attach_tree();
+                    on_commit();
+                });
+            } else {
+                watched.listener = surface->m_events.commit.listen([this] { on_commit(); });
+            }
+            attached.emplace(surface.get(), std::move(watched));
+        },
+        nullptr
+    );
+    surfaces = std::move(attached);
+}
+
+HTThumbnailCache::~HTThumbnailCache() {
+    clear();
+}
+
+HTThumbnail* HTThumbnailCache::find(WORKSPACEID ws_id) {
+    const auto it = thumbnails.find(ws_id);
+    if (it == thumbnails.end() || !it->second.fb.isAllocated())
+        return nullptr;
+    return &it->second;
+}
+
+bool HTThumbnailCache::needs_refresh(WORKSPACEID ws_id, Vector2D size, HTRenderDetail detail) {
+    const HTThumbnail* thumb = find(ws_id);
+    if (thumb == nullptr || thumb->dirty)
+        return true;
+    if (thumb->fb.m_size != size || thumb->detail != detail)
+        return true;
+    return thumb->signature != signature(ws_id);
+}
+
+void HTThumbnailCache::refresh(
+    PHLMONITOR monitor,
+    WORKSPACEID ws_id,
+    Vector2D size,
+    const Time::steady_tp& time,
+    HTRenderDetail detail
+) {
+    // Synthetic slots have nothing but layers, which the background thumbnail already holds
+    const PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByID(ws_id);
+    if (monitor == nullptr || workspace == nullptr)
+        return;
+
+    HTThumbnail& thumb = thumbnails[ws_id];
+    HTLayerHideScope hide_layers(monitor);
+    render_into(thumb, monitor, workspace, size, time, detail);
+
+    // Windows came, went or moved, watch the ones now on the workspace
+    const size_t new_signature = signature(ws_id);
+    if (new_signature != thumb.signature || thumb.surfaces.empty())
+        watch_workspace(thumb, ws_id);
+    thumb.signature = new_signature;
+}
+
+void HTThumbnailCache::watch_workspace(HTThumbnail& thumb, WORKSPACEID ws_id) {
+    thumb.surfaces.clear();
+    for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+        if (window == nullptr || !window->m_isMapped || window->workspaceID() != ws_id)
+            continue;
+        if (window->wlSurface() == nullptr || window->wlSurface()->resource() == nullptr)
+            continue;
+        thumb.surfaces.push_back(
+            makeUnique<HTSurfaceWatch>(window->wlSurface()->resource(), [this, ws_id] {
+                mark_dirty(ws_id);
+                if (on_commit)
+                    on_commit(ws_id);
+            })
+        );
+    }
+}
+
+void HTThumbnailCache::watch_layers(PHLMONITOR monitor) {
+    background.surfaces.clear();
+    overlay_surfaces.clear();
+    for (size_t i = 0; i <= HTLayerHideScope::HIDDEN_LAYERS; i++) {
+        const bool overlay = i == HTLayerHideScope::HIDDEN_LAYERS;
+        for (const PHLLSREF& ls_ref : monitor->m_layerSurfaceLayers[i]) {
+            const PHLLS ls = ls_ref.lock();
+            if (ls == nullptr || ls->wlSurface() == nullptr)
+                continue;
+            if (ls->wlSurface()->resource() == nullptr)
+                continue;
+            auto& surfaces = overlay ? overlay_surfaces : background.surfaces;
+            surfaces.push_back(
+                makeUnique<HTSurfaceWatch>(ls->wlSurface()->resource(), [this, overlay] {
+                    if (overlay)
+                        mark_all_dirty();
+                    else
+                        mark_background_dirty();
+                    if (on_commit)
+                        on_commit(WORKSPACE_INVALID);
+                })
+            );
+        }
+    }
+}
+
+HTThumbnail* HTThumbnailCache::find_background() {
+    if (!background.fb.isAllocated())
+        return nullptr;
+    return &background;
+}
+
+bool HTThumbnailCache::background_needs_refresh(PHLMONITOR monitor, Vector2D size) {
+    if (!background.fb.isAllocated() || background.dirty || background.fb.m_size != size)
+        return true;
+    return monitor != nullptr && background.signature != layer_signature(monitor);
+}
+
+void HTThumbnailCache::refresh_background(
+    PHLMONITOR monitor,
+    Vector2D size,
+    const Time::steady_tp& time
+) {
+    if (monitor == nullptr)
+        return;
+    // A null workspace renders only the layers. Cells draw their workspace thumbnail (or the live
+    // workspace) over this one, which already has the overlay.
+    HTOverlayHideScope hide_overlay(monitor);
+    render_into(background, monitor, nullptr, size, time);
+
+    const size_t new_signature = layer_signature(monitor);
+    if (new_signature != background.signature || background.surfaces.empty())
+        watch_layers(monitor);
+    background.signature = new_signature;
+}
+
+void HTThumbnailCache::render_into(
+    HTThumbnail& thumb,
+    PHLMONITOR monitor,
+    PHLWORKSPACE workspace,
+    Vector2D size,
+    const Time::steady_tp& time,
+    HTRenderDetail detail
+) {
+    if (size.x < 1 || size.y < 1)
+        return;
+
+    g_pHyprRenderer->makeEGLCurrent();
+    if (!thumb.fb.isAllocated() || thumb.fb.m_size != size) {
+        thumb.fb.release();
+        thumb.fb.alloc(size.x, size.y, monitor->m_output->state->state().drmFormat);
+    }
+
+    // Damage caused by rendering offscreen says nothing about the workspace contents
+    const bool was_blocking = ht_manager->block_damage_reporting;
+    ht_manager->block_damage_reporting = true;
+    CScopeGuard x([was_blocking] { ht_manager->block_damage_reporting = was_blocking; });
+
+    CBox render_box = {{0, 0}, size};
+    if (monitor->m_transform % 2 == 1)
+        std::swap(render_box.w, render_box.h);
+
+    CRegion fake_damage {0, 0, INT16_MAX, INT16_MAX};
+    g_pHyprRenderer->beginRender(monitor, fake_damage, RENDER_MODE_FULL_FAKE, nullptr, &thumb.fb);
+    g_pHyprOpenGL->clear(CHyprColor {0, 0, 0, 0});
+
+    if (detail == HT_DETAIL_SIMPLE && workspace != nullptr)
+        render_workspace_windows_at_box(monitor, workspace, time, {{0, 0}, size});
+    else
+        render_workspace_at_box(monitor, workspace, time, render_box);
+
+    g_pHyprRenderer->endRender();
+
+    thumb.dirty = false;
+    thumb.detail = detail;
+    thumb.refreshed_at = time;
+}
+
+void HTThumbnailCache::mark_dirty(WORKSPACEID ws_id) {
+    const auto it = thumbnails.find(ws_id);
+    if (it != thumbnails.end())
+        it->second.dirty = true;
+}
+
+void HTThumbnailCache::mark_background_dirty() {
+    background.dirty = true;
+}
+
+void HTThumbnailCache::mark_all_dirty() {
+    for (auto& [id, thumb] : thumbnails)
+        thumb.dirty = true;
+    background.dirty = true;
+}
+
+void HTThumbnailCache::clear() {
+    if (thumbnails.empty() && !background.fb.isAllocated())
+        return;
+    if (g_pHyprRenderer != nullptr)
+        g_pHyprRenderer->makeEGLCurrent();
+    thumbnails.clear();
+    background.fb.release();
+    background.surfaces.clear();
+    overlay_surfaces.clear();
+    background.dirty = true;
+}
+
+void HTThumbnailCache::retain(const std::unordered_set<WORKSPACEID>& keep) {
+    auto kept = [&keep](const auto& entry) { return keep.contains(entry.first); };
+    if (std::ranges::all_of(thumbnails, kept))
+        return;
+    g_pHyprRenderer->makeEGLCurrent();
+    std::erase_if(thumbnails, std::not_fn(kept));
+}
+
+size_t HTThumbnailCache::signature(WORKSPACEID ws_id) {
+    size_t seed = 0;
+    auto combine = [&seed](size_t v) { seed ^= v + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2); };
+
+    for (const PHLWINDOW& window : g_pCompositor->m_windows) {
+        if (window == nullptr || !window->m_isMapped || window->isHidden())
+            continue;
+        if (window->workspaceID() != ws_id)
+            continue;
+        const CBox box = window->getWindowMainSurfaceBox();
+        combine((size_t)window.get());
+        combine(std::hash<double> {}(box.x));
+        combine(std::hash<double> {}(box.y));
+        combine(std::hash<double> {}(box.w));
+        combine(std::hash<double> {}(box.h));
+    }
+    return seed;
+}
+
+size_t HTThumbnailCache::layer_signature(PHLMONITOR monitor) {
+    size_t seed = 0;
+    auto combine = [&seed](size_t v) { seed ^= v + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2); };
+
+    for (size_t i = 0; i <= HTLayerHideScope::HIDDEN_LAYERS; i++) {
+        for (const PHLLSREF& ls_ref : monitor->m_layerSurfaceLayers[i]) {
+            const PHLLS ls = ls_ref.lock();
+            if (ls == nullptr)
+                continue;
+            combine((size_t)ls.get());
+            combine(std::hash<double> {}(ls->m_geometry.x));
+            combine(std::hash<double> {}(ls->m_geometry.y));
+            combine(std::hash<double> {}(ls->m_geometry.w));
+            combine(std::hash<double> {}(ls->m_geometry.h));
+        }
+    }
+    return seed;
+}
+
+HTDragPreview::~HTDragPreview() {
+    stop();
+}
+
+void HTDragPreview::start(PHLWINDOW new_window) {
+    window = new_window;
+    thumb.dirty = true;
+
+    surface_watch.reset();
+    if (new_window == nullptr || new_window->wlSurface() == nullptr)
+        return;
+    const auto surface = new_window->wlSurface()->resource();
+    if (surface != nullptr)
+        surface_watch = makeUnique<HTSurfaceWatch>(surface, [this] { thumb.dirty = true; });
+}
+
+void HTDragPreview::stop() {
+    window.reset();
+    surface_watch.reset();
+    thumb.dirty = true;
+    if (!thumb.fb.isAllocated())
+        return;
+    if (g_pHyprRenderer != nullptr)
+        g_pHyprRenderer->makeEGLCurrent();
+    thumb.fb.release();
+}
+
+HTThumbnail* HTDragPreview::find(PHLWINDOW for_window) {
+    if (for_window == nullptr || window.lock() != for_window || !thumb.fb.isAllocated())
+        return nullptr;
+    return &thumb;
+}
+
+bool HTDragPreview::needs_refresh() {
+    const PHLWINDOW locked = window.lock();
+    if (locked == nullptr)
+        return false;
+    if (thumb.dirty || !thumb.fb.isAllocated())
+        return true;
+    const PHLMONITOR monitor = locked->m_monitor.lock();
+    if (monitor == nullptr)
+        return false;
+    return thumb.fb.m_size != (locked->getWindowMainSurfaceBox().size() * monitor->m_scale).round();
+}
+
+void HTDragPreview::refresh(const Time::steady_tp& time) {
+    const PHLWINDOW locked = window.lock();
+    if (locked == nullptr)
+        return;
+    // Rendered at the scale of the monitor the window is on, whichever monitor asked for it
+    const PHLMONITOR monitor = locked->m_monitor.lock();
+    if (monitor == nullptr)
+        return;
+
+    const Vector2D size = (locked->getWindowMainSurfaceBox().size() * monitor->m_scale).round();
+    if (size.x < 1 || size.y < 1)
+        return;
+
+    g_pHyprRenderer->makeEGLCurrent();
+    if (!thumb.fb.isAllocated() || thumb.fb.m_size != size) {
+        thumb.fb.release();
+        thumb.fb.alloc(size.x, size.y, monitor->m_output->state->state().drmFormat);
+    }
+
+    const bool was_blocking = ht_manager->block_damage_reporting;
+    ht_manager->block_damage_reporting = true;
+    CScopeGuard x([was_blocking] { ht_manager->block_damage_reporting = was_blocking; });
+
+    CRegion fake_damage {0, 0, INT16_MAX, INT16_MAX};
+    g_pHyprRenderer->beginRender(monitor, fake_damage, RENDER_MODE_FULL_FAKE, nullptr, &thumb.fb);
+    g_pHyprOpenGL->clear(CHyprColor {0, 0, 0, 0});
+    // Unscaled, at the top left corner of the framebuffer
+    render_window_at_box(
+        locked,
+        monitor,
+        time,
+        CBox {monitor->m_position, locked->getWindowMainSurfaceBox().size()}
+    );
+    g_pHyprRenderer->endRender();
+
+    thumb.dirty = false;
+}
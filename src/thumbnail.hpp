@@ -0,0 +1,142 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <hyprland/src/SharedDefs.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/helpers/time/Time.hpp>
+#include <hyprland/src/render/Framebuffer.hpp>
+#include <hyprutils/math/Vector2D.hpp>
+#include <hyprutils/signal/Signal.hpp>
+
+#include "types.hpp"
+
+using namespace Render;
+
+class CWLSurfaceResource;
+
+// Calls back on every commit of a surface and of its subsurfaces. The tree is walked again when
+// the root commits, which is when subsurfaces are added or removed.
+class HTSurfaceWatch {
+  public:
+    HTSurfaceWatch(SP<CWLSurfaceResource> root, std::function<void()> on_commit);
+
+    HTSurfaceWatch(const HTSurfaceWatch&) = delete;
+    HTSurfaceWatch& operator=(const HTSurfaceWatch&) = delete;
+
+  private:
+    struct HTWatchedSurface {
+        WP<CWLSurfaceResource> surface;
+        Hyprutils::Signal::CHyprSignalListener listener;
+    };
+
+    WP<CWLSurfaceResource> root;
+    std::function<void()> on_commit;
+    std::unordered_map<const CWLSurfaceResource*, HTWatchedSurface> surfaces;
+
+    void attach_tree();
+};
+
+// Offscreen copy of one workspace, composited into its overview cell
+struct HTThumbnail {
+    CFramebuffer fb;
+    // Set when a surface drawn in it commits, cleared once the contents are rendered again
+    bool dirty = true;
+    // Cheap summary of the windows on the workspace, see HTThumbnailCache::signature
+    size_t signature = 0;
+    // Level of detail the contents were rendered at
+    HTRenderDetail detail = HT_DETAIL_FULL;
+    Time::steady_tp refreshed_at;
+    // Surfaces of the windows (or layers) drawn in it, they mark it dirty when they commit
+    std::vector<UP<HTSurfaceWatch>> surfaces;
+};
+
+// Snapshot of the window being dragged in the overview, drawn at the cursor instead of rendering
+// the window (and its decorations) every frame
+class HTDragPreview {
+  public:
+    ~HTDragPreview();
+
+    void start(PHLWINDOW window);
+    void stop();
+
+    // Returns nullptr if window is not the one being previewed or it was not rendered yet
+    HTThumbnail* find(PHLWINDOW window);
+    bool needs_refresh();
+    // Must be called outside of a monitor render pass
+    void refresh(const Time::steady_tp& time);
+
+  private:
+    PHLWINDOWREF window;
+    HTThumbnail thumb;
+    // Marks the preview dirty when the window or one of its subsurfaces commits new contents.
+    // Damage is no use here: the window is damaged on every motion while it is dragged.
+    UP<HTSurfaceWatch> surface_watch;
+};
+
+class HTThumbnailCache {
+  public:
+    HTThumbnailCache() = default;
+    ~HTThumbnailCache();
+
+    HTThumbnailCache(const HTThumbnailCache&) = delete;
+    HTThumbnailCache& operator=(const HTThumbnailCache&) = delete;
+
+    // Returns nullptr if ws_id was never rendered
+    HTThumbnail* find(WORKSPACEID ws_id);
+    // True if the thumbnail is missing, damaged, of another size or detail or its windows changed
+    bool needs_refresh(WORKSPACEID ws_id, Vector2D size, HTRenderDetail detail = HT_DETAIL_FULL);
+    // Render ws_id into its thumbnail, must be called outside of a monitor render pass.
+    // The background, bottom and top layers are left out, they live in the background thumbnail.
+    void refresh(
+        PHLMONITOR monitor,
+        WORKSPACEID ws_id,
+        Vector2D size,
+        const Time::steady_tp& time,
+        HTRenderDetail detail = HT_DETAIL_FULL
+    );
+
+    // Background, bottom and top layers (wallpaper, bars) shared by every cell of the monitor
+    HTThumbnail* find_background();
+    bool background_needs_refresh(PHLMONITOR monitor, Vector2D size);
+    void refresh_background(PHLMONITOR monitor, Vector2D size, const Time::steady_tp& time);
+
+    void mark_dirty(WORKSPACEID ws_id);
+    void mark_background_dirty();
+    void mark_all_dirty();
+    void clear();
+    // Release every workspace thumbnail not in keep, the background stays
+    void retain(const std::unordered_set<WORKSPACEID>& keep);
+
+    // Hash of the mapped windows (and their boxes) on a workspace
+    static size_t signature(WORKSPACEID ws_id);
+    // Hash of the layer surfaces (and their boxes) of a monitor, overlay included
+    static size_t layer_signature(PHLMONITOR monitor);
+
+    // Called after a surface committed and the thumbnails showing it were marked dirty, with the
+    // workspace id or WORKSPACE_INVALID for layers. Damage reported on the monitor only says
+    // where something changed, commits say which thumbnail changed.
+    std::function<void(WORKSPACEID)> on_commit;
+
+  private:
+    std::unordered_map<WORKSPACEID, HTThumbnail> thumbnails;
+    HTThumbnail background;
+    // Overlay layers are drawn into every workspace thumbnail, their commits dirty them all
+    std::vector<UP<HTSurfaceWatch>> overlay_surfaces;
+
+    // Watch the surfaces of the windows on ws_id, or of the layers of monitor for the background
+    void watch_workspace(HTThumbnail& thumb, WORKSPACEID ws_id);
+    void watch_layers(PHLMONITOR monitor);
+
+    void render_into(
+        HTThumbnail& thumb,
+        PHLMONITOR monitor,
+        PHLWORKSPACE workspace,
+        Vector2D size,
+        const Time::steady_tp& time,
+        HTRenderDetail detail = HT_DETAIL_FULL
+    );
+};
@@ -27,4 +27,17 @@ typedef void (*render_window_t)(
     bool standalone
 );
 
+typedef void (*add_damage_box_t)(void* thisptr, const CBox& box);
+typedef void (*add_damage_region_t)(void* thisptr, const pixman_region32_t* rg);
+
 typedef long VIEWID;
+
+// How much of a workspace is drawn, lowered for small overview cells (see grid:lod_*)
+enum HTRenderDetail {
+    // Everything, through the original renderWorkspace
+    HT_DETAIL_FULL,
+    // Window surfaces only: no layers, decorations or shadows
+    HT_DETAIL_SIMPLE,
+    // A solid rectangle per window
+    HT_DETAIL_PLACEHOLDER,
+};
@@ -0,0 +1,69 @@
+// Storage reuse of pass elements, see src/pass/draw_pool.hpp. Built by `meson test`.
+
+#include <cstdio>
+#include <string>
+
+#include "pass/draw_pool.hpp"
+
+static int failures = 0;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr);          \
+            failures++;                                                                            \
+        }                                                                                          \
+    } while (0)
+
+// One frame of an element: take the storage, add count draws, give it back when freed
+static const std::string* frame(HTDrawPool<std::string>& pool, size_t count) {
+    std::vector<std::string> draws = pool.acquire();
+    CHECK(draws.empty());
+    for (size_t i = 0; i < count; i++)
+        draws.push_back("cell");
+    const std::string* data = draws.data();
+    pool.release(std::move(draws));
+    return data;
+}
+
+static void test_steady_frames_reuse_storage() {
+    HTDrawPool<std::string> pool;
+    const std::string* first = frame(pool, 9);
+    // Same number of cells, no new allocation
+    CHECK(frame(pool, 9) == first);
+    CHECK(frame(pool, 9) == first);
+    // Fewer cells fit as well
+    CHECK(frame(pool, 4) == first);
+}
+
+static void test_capacity_only_grows() {
+    HTDrawPool<std::string> pool;
+    frame(pool, 16);
+
+    std::vector<std::string> draws = pool.acquire();
+    CHECK(draws.capacity() >= 16);
+
+    // A smaller vector given back does not replace the larger spare
+    std::vector<std::string> small;
+    small.reserve(2);
+    pool.release(std::move(small));
+    pool.release(std::move(draws));
+    CHECK(pool.acquire().capacity() >= 16);
+}
+
+static void test_empty_pool() {
+    HTDrawPool<std::string> pool;
+    CHECK(pool.acquire().empty());
+}
+
+int main() {
+    test_steady_frames_reuse_storage();
+    test_capacity_only_grows();
+    test_empty_pool();
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
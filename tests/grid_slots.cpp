@@ -0,0 +1,133 @@
+// Slot assignment of the grid layout, see src/layout/grid_slots.hpp. Built by `meson test`.
+
+#include <cstdio>
+
+#include "layout/grid_slots.hpp"
+
+static int failures = 0;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr);          \
+            failures++;                                                                            \
+        }                                                                                          \
+    } while (0)
+
+// One layer of 2 x 2: workspaces 1 and 2 exist, synthetic ids 10 and 11 fill the rest, like
+// refresh_workspace_cache leaves it
+static HTGridSlots make_slots() {
+    HTGridSlots slots;
+    slots.reset(1, 2, 2);
+    slots.set(0, 1, true);
+    slots.set(1, 2, true);
+    slots.set(2, 10, false);
+    slots.set(3, 11, false);
+    return slots;
+}
+
+static void test_layout() {
+    HTGridSlots slots = make_slots();
+    CHECK(slots.size() == 4);
+    CHECK(slots.at(0, 0, 0) == 1);
+    CHECK(slots.at(0, 1, 0) == 2);
+    CHECK(slots.at(0, 0, 1) == 10);
+    CHECK(slots.at(0, 1, 1) == 11);
+    CHECK(slots.at(1, 0, 0) == HTGridSlots::INVALID);
+    CHECK(slots.at(0, 2, 0) == HTGridSlots::INVALID);
+    CHECK(slots.index(0, -1, 0) == -1);
+    CHECK(!slots.is_free(0) && !slots.is_free(1));
+    CHECK(slots.is_free(2) && slots.is_free(3));
+}
+
+static void test_assign_takes_first_free_slot() {
+    HTGridSlots slots = make_slots();
+    CHECK(slots.assign(5));
+    CHECK(slots.at(0, 0, 1) == 5);
+    CHECK(!slots.contains(10));
+    CHECK(!slots.is_free(2));
+    CHECK(slots.is_free(3));
+}
+
+static void test_removed_slot_is_sticky_until_taken() {
+    HTGridSlots slots = make_slots();
+    slots.remove(1);
+    CHECK(slots.contains(1));
+    CHECK(slots.is_free(0));
+
+    // The workspace comes back before anything took its slot
+    CHECK(slots.assign(1));
+    CHECK(slots.at(0, 0, 0) == 1);
+    CHECK(!slots.is_free(0));
+
+    // A new workspace takes the first free slot, which is the removed one
+    slots.remove(1);
+    CHECK(slots.assign(6));
+    CHECK(slots.at(0, 0, 0) == 6);
+    CHECK(!slots.contains(1));
+}
+
+static void test_release_frees_the_slot() {
+    HTGridSlots slots = make_slots();
+    const uint64_t generation = slots.generation();
+    slots.release(2, 12);
+    CHECK(!slots.contains(2));
+    CHECK(slots.at(0, 1, 0) == 12);
+    CHECK(slots.is_free(1));
+    CHECK(slots.generation() != generation);
+
+    // Unknown ids change nothing
+    slots.release(42, 13);
+    CHECK(!slots.contains(13));
+}
+
+static void test_rule_slots_are_never_free() {
+    HTGridSlots slots;
+    slots.is_pinned = [](HTGridSlots::WsId id) { return id == 7; };
+    slots.reset(1, 2, 2);
+    slots.set(0, 1, true);
+    slots.set(1, 10, false);
+    // Rule workspace 7 does not exist yet, its slot is still kept
+    slots.set(2, 7, false);
+    slots.set(3, 11, false);
+    CHECK(!slots.is_free(2));
+
+    CHECK(slots.assign(8));
+    CHECK(slots.at(0, 1, 0) == 8);
+    CHECK(slots.assign(9));
+    CHECK(slots.at(0, 1, 1) == 9);
+    CHECK(slots.at(0, 0, 1) == 7);
+
+    // Removing the rule workspace keeps its slot out of the free list
+    CHECK(slots.assign(7));
+    slots.remove(7);
+    CHECK(!slots.is_free(2));
+    CHECK(!slots.assign(20));
+    CHECK(slots.at(0, 0, 1) == 7);
+}
+
+static void test_full_grid() {
+    HTGridSlots slots;
+    slots.reset(1, 1, 2);
+    slots.set(0, 1, true);
+    slots.set(1, 2, true);
+    CHECK(!slots.assign(3));
+    CHECK(!slots.contains(3));
+    // Already placed workspaces still succeed
+    CHECK(slots.assign(2));
+}
+
+int main() {
+    test_layout();
+    test_assign_takes_first_free_slot();
+    test_removed_slot_is_sticky_until_taken();
+    test_release_frees_the_slot();
+    test_rule_slots_are_never_free();
+    test_full_grid();
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}